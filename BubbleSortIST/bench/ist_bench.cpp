@@ -0,0 +1,352 @@
+// Microbenchmarks for the IST pipeline stages. Every benchmark runs on all
+// MPI ranks; collective ones are bracketed by barriers and report the
+// slowest rank. Results go to stdout or --out as CSV or JSON.
+#include <mpi.h>
+#include <omp.h>
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/algorithm/ist_batch.hpp"
+#include "../src/algorithm/ist_construct.hpp"
+#include "../src/algorithm/ist_query.hpp"
+#include "../src/graph/bubble_sort_graph.hpp"
+#include "../src/parallel/metis_partition.hpp"
+#include "../src/parallel/mpi_utils.hpp"
+#include "../src/parallel/openmp_utils.hpp"
+#include "../src/parallel/prefix_partition.hpp"
+#include "../src/utils/logging.hpp"
+#include "../src/utils/permutation.hpp"
+
+namespace {
+
+struct BenchOptions {
+    int n = 8;
+    int reps = 5;
+    bool json = false;
+    std::string out;
+    std::string only;
+    std::string output_dir = "bench_output/";
+};
+
+struct BenchResult {
+    std::string name;
+    std::int64_t items = 0; // Work items per repetition, for the per-item rate
+    double min_s = 0;
+    double median_s = 0;
+};
+
+volatile std::int64_t g_sink; // Keeps the compiler from discarding benchmark loops
+
+int parse_int(const std::string& option, const std::string& value, int min, int max) {
+    try {
+        size_t used;
+        int result = std::stoi(value, &used);
+        if (used == value.size() && result >= min && result <= max) {
+            return result;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid value for " + option + ": " + value + " (expected " + std::to_string(min) +
+                                ".." + std::to_string(max) + ")");
+}
+
+BenchOptions parse_options(int argc, char* argv[]) {
+    BenchOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            return argv[++i];
+        };
+        if (option == "-n" || option == "--n") {
+            options.n = parse_int(option, value(), 2, 12);
+        } else if (option == "--reps") {
+            options.reps = parse_int(option, value(), 1, std::numeric_limits<int>::max());
+        } else if (option == "--format") {
+            std::string format = value();
+            if (format != "csv" && format != "json") {
+                throw std::invalid_argument("Invalid value for --format: " + format);
+            }
+            options.json = format == "json";
+        } else if (option == "--out") {
+            options.out = value();
+        } else if (option == "--only") {
+            options.only = value();
+        } else if (option == "-o" || option == "--output-dir") {
+            options.output_dir = value();
+            if (options.output_dir.back() != '/') {
+                options.output_dir += '/';
+            }
+        } else {
+            throw std::invalid_argument("Unknown option: " + option +
+                                        "\nUsage: bubble_sort_ist_bench [-n N] [--reps R] [--format csv|json] "
+                                        "[--out FILE] [--only SUBSTRING] [--output-dir DIR]");
+        }
+    }
+    return options;
+}
+
+// Runs body reps times; setup (untimed) runs before each repetition.
+BenchResult run_bench(const std::string& name, std::int64_t items, int reps, const std::function<void()>& body,
+                      const std::function<void()>& setup = nullptr) {
+    std::vector<double> times;
+    for (int r = 0; r < reps; ++r) {
+        if (setup) {
+            setup();
+        }
+        MPI_Barrier(MPI_COMM_WORLD);
+        double start = MPI_Wtime();
+        body();
+        double local = MPI_Wtime() - start;
+        double slowest;
+        MPI_Allreduce(&local, &slowest, 1, MPI_DOUBLE, MPI_MAX, MPI_COMM_WORLD);
+        times.push_back(slowest);
+    }
+    std::sort(times.begin(), times.end());
+    return {name, items, times.front(), times[times.size() / 2]};
+}
+
+void write_results(std::ostream& out, const BenchOptions& options, int size, const std::vector<BenchResult>& results) {
+    const int threads = omp_get_max_threads();
+    if (options.json) {
+        out << "[\n";
+        for (size_t i = 0; i < results.size(); ++i) {
+            const BenchResult& r = results[i];
+            out << "  {\"name\": \"" << r.name << "\", \"n\": " << options.n << ", \"np\": " << size
+                << ", \"threads\": " << threads << ", \"items\": " << r.items << ", \"reps\": " << options.reps
+                << ", \"min_s\": " << r.min_s << ", \"median_s\": " << r.median_s
+                << ", \"ns_per_item\": " << r.min_s * 1e9 / std::max<std::int64_t>(r.items, 1) << "}"
+                << (i + 1 < results.size() ? "," : "") << "\n";
+        }
+        out << "]\n";
+    } else {
+        out << "name,n,np,threads,items,reps,min_s,median_s,ns_per_item\n";
+        for (const BenchResult& r : results) {
+            out << r.name << ',' << options.n << ',' << size << ',' << threads << ',' << r.items << ',' << options.reps
+                << ',' << r.min_s << ',' << r.median_s << ',' << r.min_s * 1e9 / std::max<std::int64_t>(r.items, 1)
+                << '\n';
+        }
+    }
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    log_init();
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    BenchOptions options;
+    try {
+        options = parse_options(argc, argv);
+    } catch (const std::exception& e) {
+        if (rank == 0) {
+            std::cerr << e.what() << "\n";
+        }
+        log_shutdown();
+        MPI_Finalize();
+        return 2;
+    }
+    // Benchmarks would otherwise be dominated by their own progress messages
+    if (log_level() < LogLevel::Error) {
+        set_log_level(LogLevel::Error);
+    }
+
+    const int n = options.n;
+    const Rank num_vertices = factorial(n);
+    const std::pair<Rank, Rank> range = local_rank_range(num_vertices, rank, size);
+    const Rank local_count = range.second - range.first;
+    auto selected = [&](const std::string& name) {
+        return options.only.empty() || name.find(options.only) != std::string::npos;
+    };
+    std::vector<BenchResult> results;
+    // The explicit graph (and so METIS) only exists while n!(n-1) fits idx_t
+    auto skip_without_graph = [&](const std::string& name) {
+        if (metis_graph_fits(n)) {
+            return false;
+        }
+        if (rank == 0) {
+            std::cerr << "Skipping " << name << ": the explicit B_" << n << " does not fit idx_t.\n";
+        }
+        return true;
+    };
+
+    if (selected("permutation_unrank")) {
+        results.push_back(run_bench("permutation_unrank", local_count, options.reps, [&] {
+            std::uint64_t sum = 0;
+            for (Rank r = range.first; r < range.second; ++r) {
+                sum += Permutation::unrank(r, n).word();
+            }
+            g_sink = sum;
+        }));
+    }
+    if (selected("permutation_rank")) {
+        std::vector<Permutation> perms;
+        for (Rank r = range.first; r < range.second; ++r) {
+            perms.push_back(Permutation::unrank(r, n));
+        }
+        results.push_back(run_bench("permutation_rank", local_count, options.reps, [&] {
+            Rank sum = 0;
+            for (const Permutation& p : perms) {
+                sum += p.rank();
+            }
+            g_sink = sum;
+        }));
+    }
+    if (selected("adjacent_rank")) {
+        results.push_back(run_bench("adjacent_rank", local_count * (n - 1), options.reps, [&] {
+            Rank sum = 0;
+            for (Rank r = range.first; r < range.second; ++r) {
+                for (int t = 1; t <= n - 1; ++t) {
+                    sum += adjacent_rank(r, n, t);
+                }
+            }
+            g_sink = sum;
+        }));
+    }
+    if (selected("parent1")) {
+        results.push_back(run_bench("parent1_swap_positions", local_count * (n - 1), options.reps, [&] {
+            std::int64_t sum = 0;
+            int swaps[Permutation::kMaxSize];
+            for (Rank r = range.first; r < range.second; ++r) {
+                parent_swap_positions(Permutation::unrank(r, n), n, swaps);
+                sum += swaps[0] + swaps[n - 2];
+            }
+            g_sink = sum;
+        }));
+        results.push_back(run_bench("parent1_ranks", local_count * (n - 1), options.reps, [&] {
+            std::int64_t sum = 0;
+            int parents[Permutation::kMaxSize];
+            for (Rank r = range.first; r < range.second; ++r) {
+                parent_ranks(r, n, parents);
+                sum += parents[0] + parents[n - 2];
+            }
+            g_sink = sum;
+        }));
+    }
+    if (selected("parent_ranks_batch")) {
+        // Every level up to the active one, so the SIMD speedup is visible in one run
+        const SimdLevel active = simd_level();
+        for (SimdLevel level : {SimdLevel::Scalar, SimdLevel::Avx2, SimdLevel::Avx512}) {
+            if (level > active) {
+                break;
+            }
+            set_simd_level(level);
+            results.push_back(run_bench("parent_ranks_batch_" + to_string(level), local_count * (n - 1), options.reps, [&] {
+                std::int64_t sum = 0;
+                Rank ranks[kIstBatchSize] = {};
+                int parents[kIstBatchSize * (Permutation::kMaxSize - 1)];
+                for (Rank first = range.first; first < range.second; first += kIstBatchSize) {
+                    const int batch = static_cast<int>(std::min<Rank>(kIstBatchSize, range.second - first));
+                    for (int i = 0; i < batch; ++i) {
+                        ranks[i] = first + i;
+                    }
+                    parent_ranks_batch(ranks, batch, n, parents);
+                    sum += parents[0] + parents[batch * (n - 1) - 1];
+                }
+                g_sink = sum;
+            }));
+        }
+        set_simd_level(active);
+    }
+    if (selected("construct_ists_range")) {
+        results.push_back(run_bench("construct_ists_range", local_count * (n - 1), options.reps, [&] {
+            g_sink = construct_ists_range(range.first, range.second, n).size();
+        }));
+    }
+    if (selected("query_paths_to_root")) {
+        // Every local vertex once, trees round-robin; the cached variant
+        // repeats a hot set of 1024 queries that fits its cache
+        std::vector<IstQuery> queries;
+        std::vector<IstQuery> hot_queries;
+        for (Rank r = range.first; r < range.second; ++r) {
+            queries.push_back({r, static_cast<int>(r % (n - 1)) + 1});
+            hot_queries.push_back(queries[(r - range.first) % 1024]);
+        }
+        const IstQueryEngine engine(n);
+        results.push_back(run_bench("query_paths_to_root", local_count, options.reps, [&] {
+            g_sink = engine.paths_to_root(queries).size();
+        }));
+        const IstQueryEngine cached_engine(n, 1024);
+        results.push_back(run_bench("query_paths_to_root_cached", local_count, options.reps, [&] {
+            g_sink = cached_engine.paths_to_root(hot_queries).size();
+        }));
+    }
+    if (selected("graph_construction") && !skip_without_graph("graph_construction")) {
+        results.push_back(run_bench("graph_construction", num_vertices, options.reps, [&] {
+            BubbleSortGraph graph(n);
+            g_sink = graph.num_vertices();
+        }));
+    }
+    if (selected("partition_metis") && !skip_without_graph("partition_metis")) {
+        BubbleSortGraph graph(n);
+        results.push_back(run_bench("partition_metis", num_vertices, options.reps, [&] {
+            g_sink = partition_graph(graph, size).size();
+        }));
+    }
+    if (selected("partition_prefix")) {
+        // The whole prefix strategy, exact edge cut included
+        results.push_back(run_bench("partition_prefix", num_vertices, options.reps, [&] {
+            PrefixPartition prefix(n, size, kImbalanceTolerance);
+            g_sink = prefix.range(rank).second + prefix.quality().edge_cut;
+        }));
+    }
+    if (selected("partition_vertices")) {
+        // Warm the cache first, so the repetitions measure the mapped-and-scattered path
+        const std::string cache_dir = options.output_dir + "cache/";
+        partition_vertices(n, size, cache_dir);
+        results.push_back(run_bench("partition_vertices_cached", num_vertices, options.reps, [&] {
+            g_sink = partition_vertices(n, size, cache_dir).local_vertices.size();
+        }));
+    }
+
+    ParentTable parents;
+    std::vector<int> local_vertices(local_count);
+    for (Rank i = 0; i < local_count; ++i) {
+        local_vertices[i] = static_cast<int>(range.first + i);
+    }
+    if (selected("gather") || selected("output")) {
+        parents = construct_ists_range(range.first, range.second, n);
+        if (rank == 0) {
+            std::filesystem::create_directories(options.output_dir);
+        }
+    }
+    if (selected("gather")) {
+        results.push_back(run_bench("gather_parents_range", num_vertices, options.reps, [&] {
+            g_sink = gather_parents_range(parents, size, static_cast<int>(num_vertices), n).size();
+        }));
+    }
+    if (selected("output")) {
+        results.push_back(run_bench("output_binary_mpiio", num_vertices, options.reps, [&] {
+            output_ists_binary(local_vertices, parents, n, options.output_dir);
+        }));
+        results.push_back(run_bench("output_text_mpiio", num_vertices * (n - 1), options.reps, [&] {
+            output_ists_mpiio(local_vertices, parents, n, options.output_dir);
+        }));
+    }
+
+    if (rank == 0) {
+        if (options.out.empty()) {
+            write_results(std::cout, options, size, results);
+        } else {
+            std::ofstream out(options.out);
+            write_results(out, options, size, results);
+        }
+    }
+    log_shutdown();
+    MPI_Finalize();
+    return 0;
+}
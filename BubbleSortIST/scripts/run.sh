@@ -1,6 +1,8 @@
 #!/bin/bash
-mkdir -p ../build
-cd ../build
-cmake ..
+# Builds and runs one configuration; extra arguments go to bubble_sort_ist (see --help).
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+mkdir -p "$ROOT/build"
+cd "$ROOT/build"
+cmake .. $CMAKE_ARGS
 make
-mpirun -np 2 --oversubscribe ./bubble_sort_ist
\ No newline at end of file
+mpirun -np 2 --oversubscribe ./bubble_sort_ist "$@"
@@ -1,29 +1,48 @@
 #!/bin/bash
-mkdir -p ../build
-cd ../build
-cmake ..
+# Sweeps n x MPI processes x OpenMP threads without recompiling.
+# Results (CSV, one row per run/benchmark):
+#   results/runs.csv   - end-to-end timings from bubble_sort_ist --report
+#   results/bench.csv  - microbenchmarks from bubble_sort_ist_bench
+# Set GPROF=1 to build with -pg and keep a gprof report per configuration;
+# CMAKE_ARGS is passed through to cmake.
+ROOT="$(cd "$(dirname "$0")/../.." && pwd)"
+mkdir -p "$ROOT/build"
+cd "$ROOT/build"
+if [ "${GPROF:-0}" = "1" ]; then
+    cmake .. -DENABLE_GPROF=ON $CMAKE_ARGS
+else
+    cmake .. -DENABLE_GPROF=OFF $CMAKE_ARGS
+fi
 make
 
-# Test configurations
-N_VALUES="4 5 6 7"
-NP_VALUES="1 2 4"
-THREADS_VALUES="1 2 4"
+# Test configurations (override from the environment)
+N_VALUES=${N_VALUES:-"4 5 6 7"}
+NP_VALUES=${NP_VALUES:-"1 2 4"}
+THREADS_VALUES=${THREADS_VALUES:-"1 2 4"}
+RUN_ARGS=${RUN_ARGS:-""}
 
-for n in $N_VALUES; do
-    # Update main.cpp with n
-    sed -i "s/const int n = [0-9]*;/const int n = $n;/" ../BubbleSortIST/src/main.cpp
-    make
+mkdir -p results
+rm -f results/runs.csv results/bench.csv
 
+for n in $N_VALUES; do
     for np in $NP_VALUES; do
         for threads in $THREADS_VALUES; do
             echo "Running n=$n, np=$np, threads=$threads"
             export OMP_NUM_THREADS=$threads
-            /usr/bin/time -v mpirun -np $np --oversubscribe ./bubble_sort_ist 2>&1 | tee run_n${n}_np${np}_threads${threads}.log
-            # Run with gprof
-            mpirun -np $np --oversubscribe ./bubble_sort_ist
-            gprof ./bubble_sort_ist gmon.out > gprof_n${n}_np${np}_threads${threads}.txt
-            # Optional: Run with mpip
-            # mpirun -np $np --oversubscribe mpip ./bubble_sort_ist
+            mpirun -np $np --oversubscribe ./bubble_sort_ist --n $n --threads $threads \
+                --report results/runs.csv $RUN_ARGS > results/run_n${n}_np${np}_threads${threads}.log 2>&1
+            if [ "${GPROF:-0}" = "1" ]; then
+                gprof ./bubble_sort_ist gmon.out > results/gprof_n${n}_np${np}_threads${threads}.txt
+            fi
+
+            mpirun -np $np --oversubscribe ./bubble_sort_ist_bench --n $n --format csv \
+                --out results/bench_tmp.csv > /dev/null 2>&1
+            if [ -f results/bench.csv ]; then
+                tail -n +2 results/bench_tmp.csv >> results/bench.csv
+            else
+                mv results/bench_tmp.csv results/bench.csv
+            fi
+            rm -f results/bench_tmp.csv
         done
     done
-done
\ No newline at end of file
+done
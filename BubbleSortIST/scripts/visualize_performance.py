@@ -1,5 +1,5 @@
+import csv
 import os
-import re
 import matplotlib.pyplot as plt
 import numpy as np
 
@@ -8,7 +8,7 @@ print(f"np type: {type(np)}, np.arange: {hasattr(np, 'arange')}")
 
 # Use absolute path based on project root
 project_root = os.path.abspath(os.path.join(os.path.dirname(__file__), "../.."))
-log_dir = os.path.join(project_root, "build")
+log_dir = os.path.join(project_root, "build", "results")
 output_dir = os.path.join(project_root, "data", "output", "plots")
 os.makedirs(output_dir, exist_ok=True)
 
@@ -16,64 +16,34 @@ print(f"Project root: {project_root}")
 print(f"Log directory: {log_dir}")
 print(f"Output directory: {output_dir}")
 
-# Configurations
-n_values = [4, 5, 6, 7]
-np_values = [1, 2, 4]
-threads_values = [1, 2, 4]
-
 # Data storage
 total_times = {}
 section_times = {}
 gprof_times = {}
 
-# Parse log files for total and section times
-for n in n_values:
-    total_times[n] = {}
-    section_times[n] = {}
-    for np_val in np_values:
-        total_times[n][np_val] = {}
-        section_times[n][np_val] = {}
-        for threads in threads_values:
-            log_file = os.path.join(log_dir, f"run_n{n}_np{np_val}_threads{threads}.log")
-            print(f"Checking log file: {log_file}")
-            if not os.path.exists(log_file):
-                print(f"Warning: Log file not found: {log_file}")
-                continue
+# Load end-to-end runs written by run_performance.sh (bubble_sort_ist --report)
+runs_file = os.path.join(log_dir, "runs.csv")
+print(f"Reading runs from: {runs_file}")
+with open(runs_file, newline="") as f:
+    runs = list(csv.DictReader(f))
+
+n_values = sorted({int(row["n"]) for row in runs})
+np_values = sorted({int(row["np"]) for row in runs})
+threads_values = sorted({int(row["threads"]) for row in runs})
 
-            # Initialize section times
-            section_times[n][np_val][threads] = {
-                "Graph": 0.0, "Partition": 0.0, "LocalVertices": 0.0,
-                "IST": 0.0, "Gather": 0.0, "Output": 0.0, "Total": 0.0
-            }
-
-            with open(log_file, "r") as f:
-                log_content = f.read()
-
-                # Extract total time from /usr/bin/time
-                time_match = re.search(r"Elapsed \(wall clock\) time \(h:mm:ss or m:ss\): (\d+):(\d+\.\d+)", log_content)
-                if time_match:
-                    minutes, seconds = float(time_match.group(1)), float(time_match.group(2))
-                    total_times[n][np_val][threads] = minutes * 60 + seconds
-                else:
-                    total_times[n][np_val][threads] = 0.0
-                    print(f"Warning: No total time found in {log_file}")
-
-                # Extract section times from MPI_Wtime logs
-                timing_match = re.search(
-                    r"Timing: Graph=([\d.]+)s, Partition=([\d.]+)s, LocalVertices=([\d.]+)s, "
-                    r"IST=([\d.]+)s, Gather=([\d.]+)s, Output=([\d.]+)s, Total=([\d.]+)s",
-                    log_content
-                )
-                if timing_match:
-                    section_times[n][np_val][threads]["Graph"] = float(timing_match.group(1))
-                    section_times[n][np_val][threads]["Partition"] = float(timing_match.group(2))
-                    section_times[n][np_val][threads]["LocalVertices"] = float(timing_match.group(3))
-                    section_times[n][np_val][threads]["IST"] = float(timing_match.group(4))
-                    section_times[n][np_val][threads]["Gather"] = float(timing_match.group(5))
-                    section_times[n][np_val][threads]["Output"] = float(timing_match.group(6))
-                    section_times[n][np_val][threads]["Total"] = float(timing_match.group(7))
-                else:
-                    print(f"Warning: No section times found in {log_file}")
+for n in n_values:
+    total_times[n] = {np_val: {} for np_val in np_values}
+    section_times[n] = {np_val: {} for np_val in np_values}
+
+for row in runs:
+    n, np_val, threads = int(row["n"]), int(row["np"]), int(row["threads"])
+    total_times[n][np_val][threads] = float(row["total_s"])
+    section_times[n][np_val][threads] = {
+        "Graph": float(row["graph_s"]), "Partition": float(row["partition_s"]),
+        "LocalVertices": float(row["local_vertices_s"]), "IST": float(row["ist_s"]),
+        "Gather": float(row["gather_s"]), "Output": float(row["output_s"]),
+        "Verify": float(row["verify_s"]), "Total": float(row["total_s"])
+    }
 
 # Parse gprof files for function-level times
 for n in n_values:
@@ -141,6 +111,7 @@ for n in n_values:
     ist_times = []
     gather_times = []
     output_times = []
+    verify_times = []
     for np_val in np_values:
         for threads in threads_values:
             if np_val in section_times[n] and threads in section_times[n][np_val]:
@@ -151,6 +122,7 @@ for n in n_values:
                 ist_times.append(section_times[n][np_val][threads]["IST"])
                 gather_times.append(section_times[n][np_val][threads]["Gather"])
                 output_times.append(section_times[n][np_val][threads]["Output"])
+                verify_times.append(section_times[n][np_val][threads]["Verify"])
 
     x = np.arange(len(labels))
     plt.bar(x, graph_times, label="Graph")
@@ -159,6 +131,7 @@ for n in n_values:
     plt.bar(x, ist_times, bottom=np.array(graph_times) + np.array(partition_times) + np.array(local_vertices_times), label="IST")
     plt.bar(x, gather_times, bottom=np.array(graph_times) + np.array(partition_times) + np.array(local_vertices_times) + np.array(ist_times), label="Gather")
     plt.bar(x, output_times, bottom=np.array(graph_times) + np.array(partition_times) + np.array(local_vertices_times) + np.array(ist_times) + np.array(gather_times), label="Output")
+    plt.bar(x, verify_times, bottom=np.array(graph_times) + np.array(partition_times) + np.array(local_vertices_times) + np.array(ist_times) + np.array(gather_times) + np.array(output_times), label="Verify")
     plt.xlabel("Configuration (MPI Processes, OpenMP Threads)")
     plt.ylabel("Time (seconds)")
     plt.title(f"Section Timing Breakdown for n={n}")
@@ -169,7 +142,7 @@ for n in n_values:
     plt.close()
 
 # Plot 3: Speedup for n=4, threads=1
-if 4 in total_times:
+if 4 in total_times and 1 in total_times[4] and 1 in total_times[4][1]:
     plt.figure(figsize=(8, 6))
     baseline_time = total_times[4][1][1]  # np=1, threads=1
     np_vals = []
@@ -0,0 +1,98 @@
+#include "ist_batch.hpp"
+#include "ist_kernels.hpp"
+#include "../utils/dimension_dispatch.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+SimdLevel detect_simd_level() {
+#ifdef BSIST_X86_SIMD
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return SimdLevel::Avx512;
+    if (__builtin_cpu_supports("avx2")) return SimdLevel::Avx2;
+#endif
+    return SimdLevel::Scalar;
+}
+
+SimdLevel parse_level(const char* value, SimdLevel fallback) {
+    if (value == nullptr) return fallback;
+    if (std::strcmp(value, "scalar") == 0) return SimdLevel::Scalar;
+    if (std::strcmp(value, "avx2") == 0) return SimdLevel::Avx2;
+    if (std::strcmp(value, "avx512") == 0) return SimdLevel::Avx512;
+    return fallback;
+}
+
+SimdLevel clamp_level(SimdLevel level) {
+    return level < supported_simd_level() ? level : supported_simd_level();
+}
+
+std::atomic<SimdLevel>& current_level() {
+    static std::atomic<SimdLevel> level{clamp_level(parse_level(std::getenv("BSIST_SIMD"), supported_simd_level()))};
+    return level;
+}
+
+void parent_batch_scalar(const Rank* ranks, int count, int n, int* swaps, int* parents) {
+    dispatch_dimension(n, [&](auto dim) {
+        constexpr int N = decltype(dim)::value;
+        for (int i = 0; i < count; ++i) {
+            if (swaps) {
+                parent_swap_positions_fixed<N>(FixedPermutation<N>::unrank(ranks[i]).symbols, swaps + i * (N - 1));
+            }
+            if (parents) {
+                parent_ranks_fixed<N>(ranks[i], parents + i * (N - 1));
+            }
+        }
+    });
+}
+
+void parent_batch(const Rank* ranks, int count, int n, int* swaps, int* parents) {
+#ifdef BSIST_X86_SIMD
+    if (n <= kMaxSimdN) {
+        switch (simd_level()) {
+        case SimdLevel::Avx512:
+            ist_batch_detail::parent_batch_avx512(ranks, count, n, swaps, parents);
+            return;
+        case SimdLevel::Avx2:
+            ist_batch_detail::parent_batch_avx2(ranks, count, n, swaps, parents);
+            return;
+        case SimdLevel::Scalar:
+            break;
+        }
+    }
+#endif
+    parent_batch_scalar(ranks, count, n, swaps, parents);
+}
+
+} // namespace
+
+SimdLevel supported_simd_level() {
+    static const SimdLevel level = detect_simd_level();
+    return level;
+}
+
+SimdLevel simd_level() {
+    return current_level().load(std::memory_order_relaxed);
+}
+
+void set_simd_level(SimdLevel level) {
+    current_level().store(clamp_level(level), std::memory_order_relaxed);
+}
+
+std::string to_string(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::Scalar: return "scalar";
+    case SimdLevel::Avx2: return "avx2";
+    case SimdLevel::Avx512: return "avx512";
+    }
+    return "unknown";
+}
+
+void parent_swap_positions_batch(const Rank* ranks, int count, int n, int* swaps) {
+    parent_batch(ranks, count, n, swaps, nullptr);
+}
+
+void parent_ranks_batch(const Rank* ranks, int count, int n, int* parents) {
+    parent_batch(ranks, count, n, nullptr, parents);
+}
@@ -0,0 +1,39 @@
+#ifndef IST_BATCH_HPP
+#define IST_BATCH_HPP
+
+#include "../utils/permutation.hpp"
+#include <string>
+
+// Batched parent rule: many vertices per call, computed lane-parallel with
+// SIMD where the CPU allows it. Results are row-major, row i holding the n-1
+// trees of ranks[i], and identical to parent_swap_positions / parent_ranks.
+
+enum class SimdLevel { Scalar, Avx2, Avx512 };
+
+// Vertices handed to the batch kernels at a time by the construction loops.
+constexpr int kIstBatchSize = 32;
+// Largest n whose ranks fit the 32-bit SIMD lanes; larger n runs scalar.
+constexpr int kMaxSimdN = 12;
+
+// Best level both this build and the CPU support.
+SimdLevel supported_simd_level();
+// Level used by the batch kernels: the supported one, lowered by BSIST_SIMD
+// (scalar, avx2 or avx512) or set_simd_level. Requests above it are clamped.
+SimdLevel simd_level();
+void set_simd_level(SimdLevel level);
+std::string to_string(SimdLevel level);
+
+// swaps[i*(n-1) + t-1] = swap position of the parent of ranks[i] in T_t (0 for the root).
+void parent_swap_positions_batch(const Rank* ranks, int count, int n, int* swaps);
+// parents[i*(n-1) + t-1] = parent rank of ranks[i] in T_t (-1 for the root).
+void parent_ranks_batch(const Rank* ranks, int count, int n, int* parents);
+
+namespace ist_batch_detail {
+// Defined in ist_batch_avx2.cpp / ist_batch_avx512.cpp, which are compiled
+// with the matching -m flags; only call them after checking simd_level().
+// Either output may be null. Requires n <= kMaxSimdN.
+void parent_batch_avx2(const Rank* ranks, int count, int n, int* swaps, int* parents);
+void parent_batch_avx512(const Rank* ranks, int count, int n, int* swaps, int* parents);
+} // namespace ist_batch_detail
+
+#endif
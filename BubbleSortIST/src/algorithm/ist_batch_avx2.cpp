@@ -0,0 +1,46 @@
+// Built with -mavx2; only reached when simd_level() is at least Avx2.
+#include "ist_batch_simd.hpp"
+#include <immintrin.h>
+
+namespace {
+
+struct Avx2Ops {
+    static constexpr int kWidth = 8;
+    using Vec = __m256i;
+    using Mask = __m256i;
+
+    static Vec set1(std::int32_t x) { return _mm256_set1_epi32(x); }
+    static Vec load(const std::int32_t* p) { return _mm256_load_si256(reinterpret_cast<const __m256i*>(p)); }
+    static void store(std::int32_t* p, Vec v) { _mm256_store_si256(reinterpret_cast<__m256i*>(p), v); }
+    static Vec add(Vec a, Vec b) { return _mm256_add_epi32(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm256_sub_epi32(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm256_mullo_epi32(a, b); }
+    static Mask eq(Vec a, Vec b) { return _mm256_cmpeq_epi32(a, b); }
+    static Mask gt(Vec a, Vec b) { return _mm256_cmpgt_epi32(a, b); }
+    static Mask mask_and(Mask a, Mask b) { return _mm256_and_si256(a, b); }
+    static Mask mask_andnot(Mask a, Mask b) { return _mm256_andnot_si256(a, b); }
+    static Vec select(Mask m, Vec a, Vec b) { return _mm256_blendv_epi8(b, a, m); }
+
+    static Vec gather(const std::int32_t* table, Vec row) {
+        const Vec index = _mm256_add_epi32(_mm256_slli_epi32(row, 3), _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7));
+        return _mm256_i32gather_epi32(table, index, 4);
+    }
+
+    // Single-precision estimate, then a correction by one either way
+    static Vec div_small(Vec r, std::int32_t f) {
+        if (f == 1) {
+            return r;
+        }
+        const __m256 estimate = _mm256_mul_ps(_mm256_cvtepi32_ps(r), _mm256_set1_ps(1.0f / static_cast<float>(f)));
+        Vec q = _mm256_cvttps_epi32(estimate);
+        const Vec rest = _mm256_sub_epi32(r, _mm256_mullo_epi32(q, set1(f)));
+        q = _mm256_add_epi32(q, _mm256_cmpgt_epi32(_mm256_setzero_si256(), rest));
+        return _mm256_sub_epi32(q, _mm256_cmpgt_epi32(rest, set1(f - 1)));
+    }
+};
+
+} // namespace
+
+void ist_batch_detail::parent_batch_avx2(const Rank* ranks, int count, int n, int* swaps, int* parents) {
+    parent_batch_dispatch<Avx2Ops>(ranks, count, n, swaps, parents);
+}
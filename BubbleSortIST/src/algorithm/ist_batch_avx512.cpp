@@ -0,0 +1,47 @@
+// Built with -mavx512f; only reached when simd_level() is Avx512.
+#include "ist_batch_simd.hpp"
+#include <immintrin.h>
+
+namespace {
+
+struct Avx512Ops {
+    static constexpr int kWidth = 16;
+    using Vec = __m512i;
+    using Mask = __mmask16;
+
+    static Vec set1(std::int32_t x) { return _mm512_set1_epi32(x); }
+    static Vec load(const std::int32_t* p) { return _mm512_load_si512(p); }
+    static void store(std::int32_t* p, Vec v) { _mm512_store_si512(p, v); }
+    static Vec add(Vec a, Vec b) { return _mm512_add_epi32(a, b); }
+    static Vec sub(Vec a, Vec b) { return _mm512_sub_epi32(a, b); }
+    static Vec mul(Vec a, Vec b) { return _mm512_mullo_epi32(a, b); }
+    static Mask eq(Vec a, Vec b) { return _mm512_cmpeq_epi32_mask(a, b); }
+    static Mask gt(Vec a, Vec b) { return _mm512_cmpgt_epi32_mask(a, b); }
+    static Mask mask_and(Mask a, Mask b) { return _mm512_kand(a, b); }
+    static Mask mask_andnot(Mask a, Mask b) { return _mm512_kandn(a, b); }
+    static Vec select(Mask m, Vec a, Vec b) { return _mm512_mask_blend_epi32(m, b, a); }
+
+    static Vec gather(const std::int32_t* table, Vec row) {
+        const Vec index = _mm512_add_epi32(_mm512_slli_epi32(row, 4),
+                                           _mm512_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15));
+        return _mm512_i32gather_epi32(index, table, 4);
+    }
+
+    // Single-precision estimate, then a correction by one either way
+    static Vec div_small(Vec r, std::int32_t f) {
+        if (f == 1) {
+            return r;
+        }
+        const __m512 estimate = _mm512_mul_ps(_mm512_cvtepi32_ps(r), _mm512_set1_ps(1.0f / static_cast<float>(f)));
+        Vec q = _mm512_cvttps_epi32(estimate);
+        const Vec rest = _mm512_sub_epi32(r, _mm512_mullo_epi32(q, set1(f)));
+        q = _mm512_mask_sub_epi32(q, _mm512_cmplt_epi32_mask(rest, _mm512_setzero_si512()), q, set1(1));
+        return _mm512_mask_add_epi32(q, _mm512_cmpge_epi32_mask(rest, set1(f)), q, set1(1));
+    }
+};
+
+} // namespace
+
+void ist_batch_detail::parent_batch_avx512(const Rank* ranks, int count, int n, int* swaps, int* parents) {
+    parent_batch_dispatch<Avx512Ops>(ranks, count, n, swaps, parents);
+}
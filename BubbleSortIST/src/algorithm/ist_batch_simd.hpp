@@ -0,0 +1,189 @@
+#ifndef IST_BATCH_SIMD_HPP
+#define IST_BATCH_SIMD_HPP
+
+// Lane-parallel parent rule shared by the AVX2 and AVX-512 translation units.
+// Only include it from a file compiled for the target instruction set. All
+// helpers have internal linkage so no ISA-specific inline code can be picked
+// by the linker for a generic caller.
+//
+// Ops provides kWidth 32-bit lanes:
+//   Vec, Mask, set1, load, store, add, sub, mul, eq, gt, mask_and,
+//   mask_andnot (~a & b), select (m ? a : b), gather(table, row) =
+//   table[row * kWidth + lane], and div_small(r, f) = r / f for a small
+//   quotient.
+
+#include "ist_batch.hpp"
+#include <cstdint>
+
+namespace {
+
+constexpr std::int32_t batch_factorial(int n) {
+    return n <= 1 ? 1 : n * batch_factorial(n - 1);
+}
+
+// One batch of Ops::kWidth vertices, transposed: every Vec holds one
+// position, symbol or tree of all lanes. Mirrors VertexState; see there for
+// the rule itself. Tables are SoA rows [i][lane] so per-lane lookups can be
+// gathers. swaps and parents are [t-1][lane]; parents may be null.
+template <typename Ops, int N>
+inline void parent_batch_kernel(const std::int32_t* ranks, std::int32_t* swaps, std::int32_t* parents) {
+    using Vec = typename Ops::Vec;
+    using Mask = typename Ops::Mask;
+    constexpr int W = Ops::kWidth;
+    alignas(64) std::int32_t a_table[(N + 1) * W];   // row 0: no symbol
+    alignas(64) std::int32_t pos_table[(N + 1) * W]; // row 0: no position
+    alignas(64) std::int32_t adj_table[N * W];       // row 0: the root has no parent
+
+    const Vec zero = Ops::set1(0);
+    const Vec one = Ops::set1(1);
+    const Vec rank = Ops::load(ranks);
+
+    // Lehmer digits, 1-based positions
+    Vec digit[N + 1];
+    Vec rest = rank;
+#pragma GCC unroll 16
+    for (int i = 1; i <= N; ++i) {
+        const std::int32_t f = batch_factorial(N - i);
+        digit[i] = Ops::div_small(rest, f);
+        rest = Ops::sub(rest, Ops::mul(digit[i], Ops::set1(f)));
+    }
+
+    // Digits to 0-based symbols from the right: every symbol to the right
+    // that is not below a[i] moves up by one
+    Vec a[N + 1];
+#pragma GCC unroll 16
+    for (int i = 1; i <= N; ++i) {
+        a[i] = digit[i];
+    }
+#pragma GCC unroll 16
+    for (int i = N - 1; i >= 1; --i) {
+#pragma GCC unroll 16
+        for (int j = i + 1; j <= N; ++j) {
+            a[j] = Ops::select(Ops::gt(a[i], a[j]), a[j], Ops::add(a[j], one));
+        }
+    }
+    Vec pos[N + 1];
+    Vec mstar = zero;
+#pragma GCC unroll 16
+    for (int i = 1; i <= N; ++i) {
+        a[i] = Ops::add(a[i], one);
+        pos[i] = zero;
+        mstar = Ops::select(Ops::eq(a[i], Ops::set1(i)), mstar, Ops::set1(i));
+    }
+#pragma GCC unroll 16
+    for (int i = 1; i <= N; ++i) {
+#pragma GCC unroll 16
+        for (int s = 1; s <= N; ++s) {
+            pos[s] = Ops::select(Ops::eq(a[i], Ops::set1(s)), Ops::set1(i), pos[s]);
+        }
+    }
+    Ops::store(a_table, zero);
+    Ops::store(pos_table, zero);
+#pragma GCC unroll 16
+    for (int i = 1; i <= N; ++i) {
+        Ops::store(a_table + i * W, a[i]);
+        Ops::store(pos_table + i * W, pos[i]);
+    }
+
+    // Level m = mstar and the region S
+    const Vec m = mstar;
+    const Vec m1 = Ops::sub(m, one); // -1 for the identity
+    const Vec am = Ops::gather(a_table, m);
+    const Vec am1 = Ops::gather(a_table, Ops::select(Ops::gt(m, zero), m1, zero));
+    const Mask in_s = Ops::mask_and(Ops::eq(am, m1), Ops::eq(am1, m));
+    Vec r = zero;
+#pragma GCC unroll 16
+    for (int i = 1; i <= N - 2; ++i) {
+        const Vec iv = Ops::set1(i);
+        r = Ops::select(Ops::mask_andnot(Ops::eq(a[i], iv), Ops::gt(m1, iv)), iv, r);
+    }
+    r = Ops::select(in_s, r, zero);
+    const Vec c = Ops::gather(a_table, r);
+    const Vec pos_m = Ops::gather(pos_table, m);
+    const Vec pos_c = Ops::gather(pos_table, c);
+    // Without r, T_{m-1} takes the exit edge m-1 directly
+    const Vec pos_r = Ops::select(Ops::eq(r, zero), m1, Ops::gather(pos_table, r));
+    const Vec not_identity = Ops::select(Ops::eq(m, zero), zero, one);
+
+#pragma GCC unroll 16
+    for (int t = 1; t <= N - 1; ++t) {
+        const Vec tv = Ops::set1(t);
+        Vec p = Ops::select(Ops::eq(am, tv), pos_m, pos[t]);
+        Vec ps = Ops::select(Ops::eq(r, tv), pos_c, pos[t]);
+        ps = Ops::select(Ops::eq(c, tv), m1, ps);
+        ps = Ops::select(Ops::eq(m1, tv), pos_r, ps);
+        p = Ops::select(in_s, ps, p);
+        p = Ops::select(Ops::gt(tv, m1), Ops::mul(tv, not_identity), p);
+        Ops::store(swaps + (t - 1) * W, p);
+    }
+    if (parents == nullptr) {
+        return;
+    }
+
+    // Neighbor rank per swap position from two digits (see adjacent_rank):
+    // with d = digit[p+1] - digit[p], the rank moves by
+    // d * (f1 - f2) - f2 if digit[p] > digit[p+1], else d * (f1 - f2) + f1
+    Ops::store(adj_table, Ops::set1(-1));
+#pragma GCC unroll 16
+    for (int p = 1; p <= N - 1; ++p) {
+        const std::int32_t f1 = batch_factorial(N - p);
+        const std::int32_t f2 = batch_factorial(N - p - 1);
+        const Vec d = Ops::sub(digit[p + 1], digit[p]);
+        const Vec step = Ops::select(Ops::gt(digit[p], digit[p + 1]), Ops::set1(-f2), Ops::set1(f1));
+        Ops::store(adj_table + p * W, Ops::add(rank, Ops::add(Ops::mul(d, Ops::set1(f1 - f2)), step)));
+    }
+#pragma GCC unroll 16
+    for (int t = 1; t <= N - 1; ++t) {
+        Ops::store(parents + (t - 1) * W, Ops::gather(adj_table, Ops::load(swaps + (t - 1) * W)));
+    }
+}
+
+// Splits count vertices into kWidth-lane batches (the last one padded with
+// the identity) and transposes the results back to rows.
+template <typename Ops, int N>
+void parent_batch_rows(const Rank* ranks, int count, int* swaps, int* parents) {
+    constexpr int W = Ops::kWidth;
+    alignas(64) std::int32_t lane_ranks[W];
+    alignas(64) std::int32_t swap_lanes[(N - 1) * W];
+    alignas(64) std::int32_t parent_lanes[(N - 1) * W];
+    for (int base = 0; base < count; base += W) {
+        const int lanes = count - base < W ? count - base : W;
+        for (int l = 0; l < W; ++l) {
+            lane_ranks[l] = l < lanes ? static_cast<std::int32_t>(ranks[base + l]) : 0;
+        }
+        parent_batch_kernel<Ops, N>(lane_ranks, swap_lanes, parents ? parent_lanes : nullptr);
+        for (int l = 0; l < lanes; ++l) {
+            const int row = (base + l) * (N - 1);
+            for (int t = 0; t < N - 1; ++t) {
+                if (swaps) {
+                    swaps[row + t] = swap_lanes[t * W + l];
+                }
+                if (parents) {
+                    parents[row + t] = parent_lanes[t * W + l];
+                }
+            }
+        }
+    }
+}
+
+template <typename Ops>
+void parent_batch_dispatch(const Rank* ranks, int count, int n, int* swaps, int* parents) {
+    switch (n) {
+    case 2: parent_batch_rows<Ops, 2>(ranks, count, swaps, parents); break;
+    case 3: parent_batch_rows<Ops, 3>(ranks, count, swaps, parents); break;
+    case 4: parent_batch_rows<Ops, 4>(ranks, count, swaps, parents); break;
+    case 5: parent_batch_rows<Ops, 5>(ranks, count, swaps, parents); break;
+    case 6: parent_batch_rows<Ops, 6>(ranks, count, swaps, parents); break;
+    case 7: parent_batch_rows<Ops, 7>(ranks, count, swaps, parents); break;
+    case 8: parent_batch_rows<Ops, 8>(ranks, count, swaps, parents); break;
+    case 9: parent_batch_rows<Ops, 9>(ranks, count, swaps, parents); break;
+    case 10: parent_batch_rows<Ops, 10>(ranks, count, swaps, parents); break;
+    case 11: parent_batch_rows<Ops, 11>(ranks, count, swaps, parents); break;
+    case 12: parent_batch_rows<Ops, 12>(ranks, count, swaps, parents); break;
+    default: break; // The caller keeps larger n on the scalar path
+    }
+}
+
+} // namespace
+
+#endif
@@ -1,32 +1,59 @@
 #include "ist_construct.hpp"
+#include "ist_kernels.hpp"
+#include "../utils/dimension_dispatch.hpp"
 #include "../utils/logging.hpp"
-#include <unordered_map>
 #include <stdexcept>
 
-std::unordered_map<std::string, int> identity_cache;
+int parent_swap_position(const Permutation& v, int t, int n) {
+    int swaps[Permutation::kMaxSize];
+    parent_swap_positions(v, n, swaps);
+    return swaps[t - 1];
+}
+
+void parent_swap_positions(const Permutation& v, int n, int* out) {
+    dispatch_dimension(n, [&](auto dim) {
+        constexpr int N = decltype(dim)::value;
+        std::array<std::uint8_t, N> symbols;
+        for (int i = 0; i < N; ++i) {
+            symbols[i] = static_cast<std::uint8_t>(v[i]);
+        }
+        parent_swap_positions_fixed<N>(symbols, out);
+    });
+}
+
+void parent_ranks(Rank r, int n, int* out) {
+    if (n > kMaxIntRankN) {
+        LOG_ERROR("parent_ranks: ranks of B_" + std::to_string(n) + " do not fit int");
+        throw std::invalid_argument("parent_ranks supports n <= " + std::to_string(kMaxIntRankN));
+    }
+    dispatch_dimension(n, [&](auto dim) { parent_ranks_fixed<decltype(dim)::value>(r, out); });
+}
+
+Permutation parent1(const Permutation& v, int t, int n) {
+    return v.swap(parent_swap_position(v, t, n));
+}
 
 int parent1(const BubbleSortGraph& graph, int v_idx, int t, int n) {
     if (v_idx < 0 || v_idx >= graph.num_vertices()) {
-        log_error("Invalid vertex index: " + std::to_string(v_idx));
+        LOG_ERROR("Invalid vertex index: " + std::to_string(v_idx));
         throw std::runtime_error("Invalid vertex index");
     }
     if (t < 1 || t > n - 1) {
-        log_error("Invalid tree index t: " + std::to_string(t));
+        LOG_ERROR("Invalid tree index t: " + std::to_string(t));
         throw std::runtime_error("Invalid tree index");
     }
+    int p = parent_swap_position(graph.vertex(v_idx), t, n);
+    return p == 0 ? -1 : graph.get_adjacent(v_idx, p - 1);
+}
 
-    log_info("Computing parent1 for vertex " + std::to_string(v_idx) + ", tree T_" + std::to_string(t));
-
-    const Permutation& v = graph.vertices()[v_idx];
-    const std::vector<int>& adj = graph.get_adjacent(v_idx, t - 1);
-    if (adj.empty()) {
-        log_info("No adjacent vertices for vertex " + std::to_string(v_idx) + " at t=" + std::to_string(t));
-        return -1; // No parent
+ParentTable construct_ists(const BubbleSortGraph& graph, const std::vector<int>& vertices, int n) {
+    ParentTable parents(vertices.size(), n);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+        if (vertices[i] < 0 || vertices[i] >= graph.num_vertices()) {
+            LOG_ERROR("Invalid vertex index " + std::to_string(vertices[i]));
+            throw std::runtime_error("Invalid vertex index");
+        }
+        parent_ranks(vertices[i], n, parents.row(i));
     }
-
-    // Assume parent is the first adjacent vertex (simplified for bubble-sort graph)
-    int parent_idx = adj[0];
-    log_info("Parent of vertex " + std::to_string(v_idx) + " in T_" + std::to_string(t) + " is " + std::to_string(parent_idx));
-
-    return parent_idx;
-}
\ No newline at end of file
+    return parents;
+}
@@ -2,9 +2,25 @@
 #define IST_CONSTRUCT_HPP
 
 #include "../graph/bubble_sort_graph.hpp"
+#include "../utils/parent_table.hpp"
 #include <vector>
 
+// Independent spanning trees T_1..T_{n-1} of B_n rooted at the identity.
+// Every parent differs from its child by one adjacent transposition, so a
+// parent is fully described by its swap position p (parent = v.swap(p)).
+
+// Swap position (1..n-1) of the parent of v in T_t, or 0 if v is the root.
+int parent_swap_position(const Permutation& v, int t, int n);
+// Swap positions for all n-1 trees at once in O(n); out[t-1] belongs to T_t.
+void parent_swap_positions(const Permutation& v, int n, int* out);
+// Largest n whose ranks fit int (12! < 2^31 < 13!).
+constexpr int kMaxIntRankN = 12;
+// Parent ranks of the vertex with rank r in all n-1 trees (-1 for the root).
+// Throws std::invalid_argument for n > kMaxIntRankN.
+void parent_ranks(Rank r, int n, int* out);
+
+Permutation parent1(const Permutation& v, int t, int n);
 int parent1(const BubbleSortGraph& graph, int v_idx, int t, int n);
-std::vector<std::vector<int>> construct_ists(const BubbleSortGraph& graph, const std::vector<int>& vertices, int n);
+ParentTable construct_ists(const BubbleSortGraph& graph, const std::vector<int>& vertices, int n);
 
-#endif
\ No newline at end of file
+#endif
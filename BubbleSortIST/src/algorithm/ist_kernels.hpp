@@ -0,0 +1,126 @@
+#ifndef IST_KERNELS_HPP
+#define IST_KERNELS_HPP
+
+#include "../utils/fixed_permutation.hpp"
+#include <array>
+#include <cstdint>
+
+// Parent rule of the ISTs specialized on the dimension N; the runtime-n entry
+// points in ist_construct.hpp dispatch here (see dimension_dispatch.hpp).
+
+// Per-vertex state shared by all N-1 trees. Symbols and positions are 1-based.
+//
+// B_n splits into blocks by last symbol. Block n recursively holds the trees
+// of B_{n-1}, so a vertex whose suffix m*+1..n is already sorted behaves like
+// a vertex of B_{m*} for every tree t < m*. At that level (m = m*, k = v_m):
+//   - in block t, T_t bubbles m to the right;
+//   - elsewhere, T_t bubbles t to the right (into block t);
+//   - the region S = {x m (m-1)} carries T_{m-1} to the root neighbor
+//     1..(m-2) m (m-1): T_{m-1} bubbles r = the largest misplaced symbol of x,
+//     and the trees of c = x_r and r take the exit edge and c's move instead.
+// Trees t >= m* use the edge that restores positions t, t+1 directly.
+template <int N>
+struct VertexState {
+    std::array<std::uint8_t, N + 2> a;   // a[i] = symbol at position i
+    std::array<std::uint8_t, N + 2> pos; // pos[s] = position of symbol s
+    int mstar; // largest misplaced position, 0 for the identity
+    int r;     // largest misplaced position of x in region S, 0 if none
+    bool in_s; // v_m = m-1 and v_{m-1} = m at level m = mstar
+
+    explicit VertexState(const std::array<std::uint8_t, N>& symbols) {
+#pragma GCC unroll 16
+        for (int i = 1; i <= N; ++i) {
+            a[i] = symbols[i - 1];
+            pos[a[i]] = static_cast<std::uint8_t>(i);
+        }
+        mstar = N;
+        while (mstar > 0 && a[mstar] == mstar) {
+            --mstar;
+        }
+        in_s = mstar >= 2 && a[mstar] == mstar - 1 && a[mstar - 1] == mstar;
+        r = 0;
+        if (in_s) {
+            r = mstar - 2;
+            while (r > 0 && a[r] == r) {
+                --r;
+            }
+        }
+    }
+
+    int swap_position(int t) const {
+        if (t >= mstar) {
+            return mstar == 0 ? 0 : t;
+        }
+        const int m = mstar;
+        if (in_s) {
+            if (r == 0) {
+                return t == m - 1 ? m - 1 : pos[t];
+            }
+            const int c = a[r];
+            if (t == m - 1) return pos[r];
+            if (t == c) return m - 1;
+            if (t == r) return pos[c];
+            return pos[t];
+        }
+        return a[m] == t ? pos[m] : pos[t];
+    }
+};
+
+// Swap positions of the parents in T_1..T_{N-1}; out[t-1] is 0 for the root.
+template <int N>
+inline void parent_swap_positions_fixed(const std::array<std::uint8_t, N>& symbols, int* out) {
+    VertexState<N> state(symbols);
+#pragma GCC unroll 16
+    for (int t = 1; t <= N - 1; ++t) {
+        out[t - 1] = state.swap_position(t);
+    }
+}
+
+// Parent ranks of the vertex with rank r in T_1..T_{N-1}, -1 for the root.
+// R may be narrower than Rank when N! fits (int up to N = 12).
+template <int N, typename R>
+inline void parent_ranks_fixed(Rank r, R* out) {
+    const FixedPermutation<N> v = FixedPermutation<N>::unrank(r);
+    VertexState<N> state(v.symbols);
+#pragma GCC unroll 16
+    for (int t = 1; t <= N - 1; ++t) {
+        int p = state.swap_position(t);
+        out[t - 1] = p == 0 ? R(-1) : static_cast<R>(v.adjacent_rank(r, p));
+    }
+}
+
+// Parent rank of the vertex with rank r in T_t alone, -1 for the root.
+template <int N>
+inline Rank parent_rank_fixed(Rank r, int t) {
+    const FixedPermutation<N> v = FixedPermutation<N>::unrank(r);
+    const int p = VertexState<N>(v.symbols).swap_position(t);
+    return p == 0 ? -1 : v.adjacent_rank(r, p);
+}
+
+// Path from the vertex with rank r to the root (rank 0) in T_t, both ends
+// included. Each step rebuilds the O(N) vertex state but never unranks.
+template <int N, typename Out>
+inline void root_path_fixed(Rank r, int t, Out&& emit) {
+    FixedPermutation<N> v = FixedPermutation<N>::unrank(r);
+    emit(r);
+    for (;;) {
+        const int p = VertexState<N>(v.symbols).swap_position(t);
+        if (p == 0) {
+            return;
+        }
+        r = v.swap(r, p);
+        emit(r);
+    }
+}
+
+// Ranks of all N-1 neighbors of r; out[t-1] is the neighbor via swap (t, t+1).
+template <int N, typename R>
+inline void adjacent_ranks_fixed(Rank r, R* out) {
+    const FixedPermutation<N> v = FixedPermutation<N>::unrank(r);
+#pragma GCC unroll 16
+    for (int t = 1; t <= N - 1; ++t) {
+        out[t - 1] = static_cast<R>(v.adjacent_rank(r, t));
+    }
+}
+
+#endif
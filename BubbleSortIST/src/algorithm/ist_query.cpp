@@ -0,0 +1,79 @@
+#include "ist_query.hpp"
+#include "ist_kernels.hpp"
+#include "../utils/dimension_dispatch.hpp"
+#include "../utils/instrumentation.hpp"
+#include <stdexcept>
+#include <string>
+
+IstQueryEngine::IstQueryEngine(int n, size_t path_cache_capacity)
+    : n_(n), num_vertices_(0), path_cache_(path_cache_capacity) {
+    if (n < kMinDispatchN || n > kMaxDispatchN) {
+        throw std::invalid_argument("IstQueryEngine supports n in " + std::to_string(kMinDispatchN) + ".." +
+                                    std::to_string(kMaxDispatchN) + ", got " + std::to_string(n));
+    }
+    num_vertices_ = factorial(n);
+}
+
+void IstQueryEngine::validate(Rank v, int t) const {
+    if (v < 0 || v >= num_vertices_) {
+        throw std::invalid_argument("Vertex rank out of range: " + std::to_string(v));
+    }
+    if (t < 1 || t > n_ - 1) {
+        throw std::invalid_argument("Tree index out of range: " + std::to_string(t));
+    }
+}
+
+Rank IstQueryEngine::parent(Rank v, int t) const {
+    validate(v, t);
+    return dispatch_dimension(n_, [&](auto dim) { return parent_rank_fixed<decltype(dim)::value>(v, t); });
+}
+
+std::vector<Rank> IstQueryEngine::path_to_root(Rank v, int t) const {
+    validate(v, t);
+    return cached_path(v, t);
+}
+
+std::vector<Rank> IstQueryEngine::cached_path(Rank v, int t) const {
+    const std::uint64_t key = (static_cast<std::uint64_t>(v) << 4) | static_cast<std::uint64_t>(t);
+    std::vector<Rank> path;
+    if (path_cache_.get(key, path)) {
+        return path;
+    }
+    dispatch_dimension(n_, [&](auto dim) {
+        root_path_fixed<decltype(dim)::value>(v, t, [&path](Rank r) { path.push_back(r); });
+    });
+    path_cache_.put(key, path);
+    return path;
+}
+
+std::vector<Rank> IstQueryEngine::parents(const std::vector<IstQuery>& queries) const {
+    ScopedTimer timer("ist_query_parents");
+    for (const IstQuery& q : queries) {
+        validate(q.vertex, q.tree);
+    }
+    std::vector<Rank> result(queries.size());
+    const std::int64_t count = static_cast<std::int64_t>(queries.size());
+    dispatch_dimension(n_, [&](auto dim) {
+        constexpr int N = decltype(dim)::value;
+        #pragma omp parallel for schedule(static)
+        for (std::int64_t i = 0; i < count; ++i) {
+            result[i] = parent_rank_fixed<N>(queries[i].vertex, queries[i].tree);
+        }
+    });
+    return result;
+}
+
+std::vector<std::vector<Rank>> IstQueryEngine::paths_to_root(const std::vector<IstQuery>& queries) const {
+    ScopedTimer timer("ist_query_paths");
+    for (const IstQuery& q : queries) {
+        validate(q.vertex, q.tree);
+    }
+    std::vector<std::vector<Rank>> result(queries.size());
+    const std::int64_t count = static_cast<std::int64_t>(queries.size());
+    // Path lengths vary with the vertex, so threads take small chunks
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (std::int64_t i = 0; i < count; ++i) {
+        result[i] = cached_path(queries[i].vertex, queries[i].tree);
+    }
+    return result;
+}
@@ -0,0 +1,50 @@
+#ifndef IST_QUERY_HPP
+#define IST_QUERY_HPP
+
+#include "../utils/lru_cache.hpp"
+#include "../utils/permutation.hpp"
+#include <cstdint>
+#include <vector>
+
+// One lookup: vertex rank and 1-based tree index.
+struct IstQuery {
+    Rank vertex;
+    int tree;
+};
+
+// On-demand view of the ISTs T_1..T_{n-1} of B_n: parents and root paths are
+// computed from the vertex rank alone, so nothing of size n! is ever built.
+// All members may be called concurrently.
+class IstQueryEngine {
+public:
+    // path_cache_capacity > 0 keeps that many recently used root paths.
+    explicit IstQueryEngine(int n, size_t path_cache_capacity = 0);
+
+    int dimension() const { return n_; }
+    Rank num_vertices() const { return num_vertices_; }
+
+    // Parent of v in T_t, -1 for the root (rank 0). Both functions throw
+    // std::invalid_argument for a vertex or tree out of range.
+    Rank parent(Rank v, int t) const;
+    // v, parent of v, ..., 0 along T_t.
+    std::vector<Rank> path_to_root(Rank v, int t) const;
+
+    // Batched forms, result i answering queries[i]. All queries are validated
+    // first, then answered in parallel with OpenMP.
+    std::vector<Rank> parents(const std::vector<IstQuery>& queries) const;
+    std::vector<std::vector<Rank>> paths_to_root(const std::vector<IstQuery>& queries) const;
+
+    std::int64_t cache_hits() const { return path_cache_.hits(); }
+    std::int64_t cache_misses() const { return path_cache_.misses(); }
+
+private:
+    void validate(Rank v, int t) const;
+    std::vector<Rank> cached_path(Rank v, int t) const;
+
+    int n_;
+    Rank num_vertices_;
+    // Keyed by (v << 4) | t
+    mutable LruCache<std::uint64_t, std::vector<Rank>> path_cache_;
+};
+
+#endif
@@ -1,43 +1,92 @@
 #include "bubble_sort_graph.hpp"
+#include "../algorithm/ist_kernels.hpp"
+#include "../utils/dimension_dispatch.hpp"
+#include "../utils/instrumentation.hpp"
 #include "../utils/logging.hpp"
-#include <algorithm>
+#include <limits>
+#include <stdexcept>
 
-BubbleSortGraph::BubbleSortGraph(int n) : n_(n) {
-    // Generate all permutations
-    std::vector<int> base(n);
-    for (int i = 0; i < n; ++i) {
-        base[i] = i + 1;
+BubbleSortGraph::BubbleSortGraph(int n, GraphMode mode) : n_(n), mode_(mode) {
+    ScopedTimer timer("graph_build");
+    if (n < 2 || n > 12) {
+        LOG_ERROR("Unsupported dimension n=" + std::to_string(n));
+        throw std::invalid_argument("BubbleSortGraph supports 2 <= n <= 12");
     }
-    do {
-        vertices_.emplace_back(base);
-    } while (std::next_permutation(base.begin(), base.end()));
-
-    // Initialize adjacency lists
-    adj_lists_.resize(vertices_.size(), std::vector<std::vector<int>>(n));
-    for (size_t i = 0; i < vertices_.size(); ++i) {
-        for (int t = 1; t <= n - 1; ++t) {
-            Permutation swapped = vertices_[i].swap(t);
-            for (size_t j = 0; j < vertices_.size(); ++j) {
-                if (vertices_[j] == swapped) {
-                    adj_lists_[i][t - 1].push_back(j);
-                    break;
-                }
-            }
+    num_vertices_ = static_cast<int>(factorial(n));
+
+    if (mode_ == GraphMode::Explicit) {
+        if (!metis_graph_fits(n)) {
+            LOG_ERROR("Explicit B_" + std::to_string(n) + " has more adjacency entries than idx_t can index");
+            throw std::invalid_argument("Explicit BubbleSortGraph needs n!(n-1) to fit idx_t");
+        }
+        // Every vertex has exactly n-1 neighbors, so xadj is a plain stride
+        const int degree = n - 1;
+        xadj_.resize(static_cast<size_t>(num_vertices_) + 1);
+        adjncy_.resize(static_cast<size_t>(num_vertices_) * degree);
+        for (int i = 0; i <= num_vertices_; ++i) {
+            xadj_[i] = static_cast<idx_t>(i) * degree;
         }
+        dispatch_dimension(n, [&](auto dim) {
+            constexpr int N = decltype(dim)::value;
+            for (int i = 0; i < num_vertices_; ++i) {
+                adjacent_ranks_fixed<N>(i, &adjncy_[static_cast<size_t>(i) * degree]);
+            }
+        });
     }
-    log_info("BubbleSortGraph constructed with n=" + std::to_string(n) + ", vertices=" + std::to_string(vertices_.size()));
+    LOG_INFO("BubbleSortGraph constructed with n=" + std::to_string(n) + ", vertices=" + std::to_string(num_vertices_) +
+             (is_implicit() ? " (implicit)" : ""));
+}
+
+bool metis_graph_fits(int n) {
+    return factorial(n) * (n - 1) <= static_cast<Rank>(std::numeric_limits<idx_t>::max());
+}
+
+Permutation BubbleSortGraph::vertex(int v_idx) const {
+    return Permutation::unrank(v_idx, n_);
+}
+
+int BubbleSortGraph::get_adjacent(int v_idx, int t) const {
+    if (is_implicit()) {
+        return static_cast<int>(adjacent_rank(v_idx, n_, t + 1));
+    }
+    return static_cast<int>(adjncy_[static_cast<size_t>(v_idx) * (n_ - 1) + t]);
+}
+
+const std::vector<idx_t>& BubbleSortGraph::xadj() const {
+    if (is_implicit()) {
+        throw std::logic_error("xadj() is not available on an implicit BubbleSortGraph");
+    }
+    return xadj_;
+}
+
+const std::vector<idx_t>& BubbleSortGraph::adjncy() const {
+    if (is_implicit()) {
+        throw std::logic_error("adjncy() is not available on an implicit BubbleSortGraph");
+    }
+    return adjncy_;
 }
 
 void BubbleSortGraph::to_metis_format(std::vector<idx_t>& xadj, std::vector<idx_t>& adjncy) const {
-    xadj.clear();
-    adjncy.clear();
-    xadj.push_back(0);
-    for (size_t i = 0; i < vertices_.size(); ++i) {
-        for (int t = 0; t < n_ - 1; ++t) {
-            const auto& neighbors = adj_lists_[i][t];
-            adjncy.insert(adjncy.end(), neighbors.begin(), neighbors.end());
+    if (!is_implicit()) {
+        xadj = xadj_;
+        adjncy = adjncy_;
+    } else {
+        if (!metis_graph_fits(n_)) {
+            LOG_ERROR("B_" + std::to_string(n_) + " has more adjacency entries than idx_t can index");
+            throw std::invalid_argument("METIS format needs n!(n-1) to fit idx_t");
         }
-        xadj.push_back(adjncy.size());
+        // Fixed degree n-1: no neighbor is ever missing
+        const int degree = n_ - 1;
+        xadj.resize(static_cast<size_t>(num_vertices_) + 1);
+        adjncy.resize(static_cast<size_t>(num_vertices_) * degree);
+        dispatch_dimension(n_, [&](auto dim) {
+            constexpr int N = decltype(dim)::value;
+            for (int i = 0; i < num_vertices_; ++i) {
+                xadj[i] = static_cast<idx_t>(i) * degree;
+                adjacent_ranks_fixed<N>(i, &adjncy[static_cast<size_t>(i) * degree]);
+            }
+        });
+        xadj[num_vertices_] = static_cast<idx_t>(num_vertices_) * degree;
     }
-    log_info("Converted graph to METIS format: xadj size=" + std::to_string(xadj.size()) + ", adjncy size=" + std::to_string(adjncy.size()));
-}
\ No newline at end of file
+    LOG_INFO("Converted graph to METIS format: xadj size=" + std::to_string(xadj.size()) + ", adjncy size=" + std::to_string(adjncy.size()));
+}
@@ -5,18 +5,40 @@
 #include <vector>
 #include <metis.h>
 
+// Explicit mode stores the CSR adjacency; implicit mode stores nothing and
+// derives vertices and neighbors from Lehmer ranks on demand. Vertices are
+// always unranked on demand.
+enum class GraphMode { Explicit, Implicit };
+
 class BubbleSortGraph {
 private:
     int n_; // Dimension of the graph (B_n)
-    std::vector<Permutation> vertices_; // All permutations
-    std::vector<std::vector<std::vector<int>>> adj_lists_; // Adjacency lists: adj_lists_[i][t] = adjacent vertices for vertex i via swap t
+    GraphMode mode_;
+    int num_vertices_; // n!
+    // CSR adjacency with fixed degree n-1 (explicit mode only): adjncy_[i*(n-1)+t] is the
+    // neighbor of vertex i via swap t, and xadj_[i] = i*(n-1). Kept in METIS's idx_t so
+    // partitioning can use the buffers in place.
+    std::vector<idx_t> xadj_;
+    std::vector<idx_t> adjncy_;
 
 public:
-    BubbleSortGraph(int n);
-    int num_vertices() const { return vertices_.size(); }
-    const std::vector<Permutation>& vertices() const { return vertices_; }
-    const std::vector<int>& get_adjacent(int v_idx, int t) const { return adj_lists_[v_idx][t]; }
+    BubbleSortGraph(int n, GraphMode mode = GraphMode::Explicit);
+    int dimension() const { return n_; }
+    bool is_implicit() const { return mode_ == GraphMode::Implicit; }
+    int num_vertices() const { return num_vertices_; }
+    Permutation vertex(int v_idx) const; // Unranks v_idx
+    // Vertex reached from v_idx by swapping positions t+1 and t+2 (t is 0-based), or -1 if none.
+    // Implicit mode computes it from the Lehmer digits of v_idx in O(1).
+    int get_adjacent(int v_idx, int t) const;
+    // CSR buffers in METIS format (explicit mode only)
+    const std::vector<idx_t>& xadj() const;
+    const std::vector<idx_t>& adjncy() const;
+    // Copies the CSR arrays out; the only way to get them in implicit mode
     void to_metis_format(std::vector<idx_t>& xadj, std::vector<idx_t>& adjncy) const;
 };
 
-#endif
\ No newline at end of file
+// Whether the CSR arrays of B_n (n!(n-1) adjacency entries) can be indexed
+// with idx_t; explicit graphs and METIS need it.
+bool metis_graph_fits(int n);
+
+#endif
@@ -0,0 +1,44 @@
+#include "partition_quality.hpp"
+#include "../algorithm/ist_kernels.hpp"
+#include "../utils/dimension_dispatch.hpp"
+#include "../utils/instrumentation.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <vector>
+
+std::string PartitionQuality::describe() const {
+    char text[128];
+    std::snprintf(text, sizeof(text), "edge cut %lld of %lld edges (%.2f%%), imbalance %.4f",
+                  static_cast<long long>(edge_cut), static_cast<long long>(num_edges),
+                  num_edges > 0 ? 100.0 * edge_cut / num_edges : 0.0, imbalance);
+    return text;
+}
+
+PartitionQuality measure_partition(int n, int nparts, const idx_t* parts) {
+    ScopedTimer timer("measure_partition");
+    const Rank num_vertices = factorial(n);
+    PartitionQuality quality;
+    quality.num_edges = num_vertices * (n - 1) / 2;
+
+    std::vector<Rank> sizes(nparts, 0);
+    for (Rank v = 0; v < num_vertices; ++v) {
+        ++sizes[parts[v]];
+    }
+    quality.imbalance = static_cast<double>(*std::max_element(sizes.begin(), sizes.end())) * nparts / num_vertices;
+
+    // Both endpoints see a cut edge, so the sum counts it twice
+    std::int64_t cut_ends = 0;
+    dispatch_dimension(n, [&](auto dim) {
+        constexpr int N = decltype(dim)::value;
+        #pragma omp parallel for schedule(static) reduction(+ : cut_ends)
+        for (Rank v = 0; v < num_vertices; ++v) {
+            Rank neighbors[N - 1];
+            adjacent_ranks_fixed<N>(v, neighbors);
+            for (int t = 0; t < N - 1; ++t) {
+                cut_ends += parts[neighbors[t]] != parts[v];
+            }
+        }
+    });
+    quality.edge_cut = cut_ends / 2;
+    return quality;
+}
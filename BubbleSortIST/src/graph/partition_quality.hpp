@@ -0,0 +1,24 @@
+#ifndef PARTITION_QUALITY_HPP
+#define PARTITION_QUALITY_HPP
+
+#include "../utils/permutation.hpp"
+#include <cstdint>
+#include <string>
+#include <metis.h>
+
+// Edge cut and balance of a partition of B_n, in the terms METIS uses: every
+// cut edge counts once, as in the objval of METIS_PartGraphKway.
+struct PartitionQuality {
+    std::int64_t edge_cut = 0;
+    std::int64_t num_edges = 0; // n!(n-1)/2; 0 when nothing was measured
+    double imbalance = 0;       // Largest part over the mean part size, 1 when perfectly balanced
+
+    bool measured() const { return num_edges > 0; }
+    std::string describe() const;
+};
+
+// Measures an explicit partition (parts[v] in [0, nparts) for every vertex
+// rank v) by visiting all n!(n-1) neighbor ranks with OpenMP.
+PartitionQuality measure_partition(int n, int nparts, const idx_t* parts);
+
+#endif
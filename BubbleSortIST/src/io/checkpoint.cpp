@@ -0,0 +1,229 @@
+#include "checkpoint.hpp"
+#include "ist_file.hpp"
+#include "../utils/logging.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+std::string journal_prefix(int n) {
+    return "ckpt_B" + std::to_string(n) + "_g";
+}
+
+// Generation of a journal file name for n, or -1 if it is not one
+int journal_generation(const std::string& name, int n) {
+    const std::string prefix = journal_prefix(n);
+    const std::string suffix = ".ckpt";
+    if (name.size() <= prefix.size() + suffix.size() || name.compare(0, prefix.size(), prefix) != 0 ||
+        name.compare(name.size() - suffix.size(), suffix.size(), suffix) != 0) {
+        return -1;
+    }
+    int generation = 0;
+    for (size_t i = prefix.size(); i < name.size() && name[i] != '_'; ++i) {
+        if (name[i] < '0' || name[i] > '9') {
+            return -1;
+        }
+        generation = generation * 10 + (name[i] - '0');
+    }
+    return generation;
+}
+
+bool is_complete_ist_file(const std::string& data_file, int n) {
+    std::ifstream in(data_file, std::ios::binary | std::ios::ate);
+    if (!in) {
+        return false;
+    }
+    const IstFileHeader expected = make_ist_header(n);
+    const std::uint64_t size = static_cast<std::uint64_t>(in.tellg());
+    IstFileHeader header;
+    in.seekg(0);
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    return in && std::memcmp(&header, &expected, sizeof(header)) == 0 &&
+           size == sizeof(IstFileHeader) + expected.num_vertices * expected.record_size;
+}
+
+// Appends the entries of one journal; false if its header does not match n
+bool read_journal(const std::string& filename, int n, std::vector<RankRange>& ranges) {
+    std::ifstream in(filename, std::ios::binary);
+    CheckpointHeader header;
+    if (!in.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    const std::uint64_t num_vertices = static_cast<std::uint64_t>(factorial(n));
+    if (std::memcmp(header.magic, kCheckpointMagic, sizeof(header.magic)) != 0 || header.version != kCheckpointVersion ||
+        header.n != static_cast<std::uint32_t>(n) || header.num_vertices != num_vertices) {
+        return false;
+    }
+    CheckpointEntry entry;
+    while (in.read(reinterpret_cast<char*>(&entry), sizeof(entry))) {
+        if (entry.count == 0 || entry.first >= num_vertices || entry.count > num_vertices - entry.first) {
+            LOG_ERROR("Ignoring invalid range in checkpoint " + filename);
+            continue;
+        }
+        ranges.emplace_back(static_cast<Rank>(entry.first), static_cast<Rank>(entry.first + entry.count));
+    }
+    return true;
+}
+
+void write_all(int fd, const void* data, size_t size, const std::string& filename) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0) {
+            LOG_ERROR("Failed to write checkpoint: " + filename);
+            throw std::runtime_error("Cannot write checkpoint: " + filename);
+        }
+        bytes += written;
+        size -= static_cast<size_t>(written);
+    }
+}
+
+} // namespace
+
+std::string checkpoint_path(const std::string& checkpoint_dir, int n, int generation, int rank) {
+    char name[64];
+    std::snprintf(name, sizeof(name), "%s%04d_r%05d.ckpt", journal_prefix(n).c_str(), generation, rank);
+    return checkpoint_dir + name;
+}
+
+CheckpointScan scan_checkpoints(const std::string& checkpoint_dir, const std::string& data_file, int n) {
+    CheckpointScan scan;
+    std::error_code error;
+    std::vector<RankRange> ranges;
+    const bool usable = is_complete_ist_file(data_file, n);
+    for (const auto& file : std::filesystem::directory_iterator(checkpoint_dir, error)) {
+        const int generation = journal_generation(file.path().filename().string(), n);
+        if (generation < 0) {
+            continue;
+        }
+        scan.next_generation = std::max(scan.next_generation, generation + 1);
+        if (usable && !read_journal(file.path().string(), n, ranges)) {
+            LOG_ERROR("Ignoring unreadable checkpoint " + file.path().string());
+        }
+    }
+    if (!usable && scan.next_generation > 0) {
+        LOG_INFO("Ignoring checkpoints: " + data_file + " is missing or incomplete.");
+    }
+
+    std::sort(ranges.begin(), ranges.end());
+    for (const RankRange& range : ranges) {
+        if (!scan.completed.empty() && range.first <= scan.completed.back().second) {
+            scan.completed.back().second = std::max(scan.completed.back().second, range.second);
+        } else {
+            scan.completed.push_back(range);
+        }
+    }
+    return scan;
+}
+
+void remove_checkpoints(const std::string& checkpoint_dir, int n) {
+    std::error_code error;
+    for (const auto& file : std::filesystem::directory_iterator(checkpoint_dir, error)) {
+        if (journal_generation(file.path().filename().string(), n) >= 0) {
+            std::filesystem::remove(file.path(), error);
+        }
+    }
+}
+
+std::vector<RankRange> uncovered_ranges(const std::vector<RankRange>& covered, Rank total) {
+    std::vector<RankRange> result;
+    Rank next = 0;
+    for (const RankRange& range : covered) {
+        if (range.first > next) {
+            result.emplace_back(next, range.first);
+        }
+        next = std::max(next, range.second);
+    }
+    if (next < total) {
+        result.emplace_back(next, total);
+    }
+    return result;
+}
+
+Rank range_count(const std::vector<RankRange>& ranges) {
+    Rank count = 0;
+    for (const RankRange& range : ranges) {
+        count += range.second - range.first;
+    }
+    return count;
+}
+
+std::vector<RankRange> split_ranges(const std::vector<RankRange>& ranges, int part, int parts) {
+    // Offsets of this share within the concatenation of all ranges
+    const Rank total = range_count(ranges);
+    const Rank base = total / parts;
+    const Rank extra = total % parts;
+    const Rank begin = part * base + std::min<Rank>(part, extra);
+    const Rank end = begin + base + (part < extra ? 1 : 0);
+
+    std::vector<RankRange> result;
+    Rank offset = 0;
+    for (const RankRange& range : ranges) {
+        const Rank size = range.second - range.first;
+        const Rank first = std::max(begin, offset);
+        const Rank last = std::min(end, offset + size);
+        if (first < last) {
+            result.emplace_back(range.first + (first - offset), range.first + (last - offset));
+        }
+        offset += size;
+    }
+    return result;
+}
+
+CheckpointWriter::CheckpointWriter(const std::string& filename, MPI_File data, int n, double interval_seconds)
+    : filename_(filename),
+      data_(data),
+      interval_(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(interval_seconds))),
+      last_flush_(std::chrono::steady_clock::now()) {
+    fd_ = ::open(filename.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd_ < 0) {
+        LOG_ERROR("Failed to open checkpoint " + filename);
+        throw std::runtime_error("Cannot open checkpoint: " + filename);
+    }
+    CheckpointHeader header;
+    std::memcpy(header.magic, kCheckpointMagic, sizeof(header.magic));
+    header.version = kCheckpointVersion;
+    header.n = n;
+    header.num_vertices = factorial(n);
+    write_all(fd_, &header, sizeof(header), filename_);
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    close(fd_);
+}
+
+void CheckpointWriter::add(Rank first, Rank count) {
+    if (!pending_.empty() && pending_.back().first + pending_.back().count == static_cast<std::uint64_t>(first)) {
+        pending_.back().count += count;
+    } else {
+        pending_.push_back({static_cast<std::uint64_t>(first), static_cast<std::uint64_t>(count)});
+    }
+    if (std::chrono::steady_clock::now() - last_flush_ >= interval_) {
+        flush();
+    }
+}
+
+void CheckpointWriter::flush() {
+    last_flush_ = std::chrono::steady_clock::now();
+    if (pending_.empty()) {
+        return;
+    }
+    // The records must be durable before the journal claims them
+    if (MPI_File_sync(data_) != MPI_SUCCESS) {
+        LOG_ERROR("Failed to sync output before checkpointing to " + filename_);
+        throw std::runtime_error("Cannot sync output for checkpoint: " + filename_);
+    }
+    write_all(fd_, pending_.data(), pending_.size() * sizeof(CheckpointEntry), filename_);
+    if (fdatasync(fd_) != 0) {
+        LOG_ERROR("Failed to sync checkpoint: " + filename_);
+        throw std::runtime_error("Cannot sync checkpoint: " + filename_);
+    }
+    pending_.clear();
+}
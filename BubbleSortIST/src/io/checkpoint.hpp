@@ -0,0 +1,85 @@
+#ifndef CHECKPOINT_HPP
+#define CHECKPOINT_HPP
+
+#include "../utils/permutation.hpp"
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+
+// Checkpoints of the streamed .ist output. Records sit at rank-indexed
+// offsets of the .ist file, so the file itself holds the results; a journal
+// only lists the rank ranges known to be on disk. Each rank of each run
+// (generation) appends to its own journal:
+//   CheckpointHeader, then one CheckpointEntry per flushed range.
+// Entries are appended only after the records they cover were synced, so a
+// crash can at worst leave a torn last entry, which readers ignore.
+struct CheckpointHeader {
+    char magic[8];               // kCheckpointMagic
+    std::uint32_t version;       // kCheckpointVersion
+    std::uint32_t n;             // Dimension of B_n
+    std::uint64_t num_vertices;  // n!
+};
+
+struct CheckpointEntry {
+    std::uint64_t first;         // First vertex rank of the range
+    std::uint64_t count;         // Vertices in the range
+};
+
+static_assert(sizeof(CheckpointHeader) == 24, "CheckpointHeader must have no padding");
+static_assert(sizeof(CheckpointEntry) == 16, "CheckpointEntry must have no padding");
+
+constexpr char kCheckpointMagic[8] = {'B', 'S', 'C', 'K', 'P', 'T', '\0', '\0'};
+constexpr std::uint32_t kCheckpointVersion = 1;
+
+using RankRange = std::pair<Rank, Rank>; // [first, second)
+
+std::string checkpoint_path(const std::string& checkpoint_dir, int n, int generation, int rank);
+
+struct CheckpointScan {
+    std::vector<RankRange> completed; // Sorted, disjoint and merged
+    int next_generation = 0;          // One past the highest generation found
+};
+
+// Reads every journal for n in checkpoint_dir, whatever rank count wrote it.
+// Journals only describe data_file, so nothing counts as completed when it is
+// missing or not a full .ist file for n. Unreadable journals are skipped.
+CheckpointScan scan_checkpoints(const std::string& checkpoint_dir, const std::string& data_file, int n);
+// Deletes all journals for n in checkpoint_dir.
+void remove_checkpoints(const std::string& checkpoint_dir, int n);
+
+// Parts of [0, total) not covered by the sorted, disjoint ranges.
+std::vector<RankRange> uncovered_ranges(const std::vector<RankRange>& covered, Rank total);
+Rank range_count(const std::vector<RankRange>& ranges);
+// Share `part` of `parts` of the vertices in ranges: contiguous in range
+// order, with sizes as in local_rank_range.
+std::vector<RankRange> split_ranges(const std::vector<RankRange>& ranges, int part, int parts);
+
+// Appends the ranges one rank has written to its journal. data is the handle
+// the records are written through; MPI_File_sync is collective over its
+// communicator, so it should be opened on MPI_COMM_SELF.
+class CheckpointWriter {
+public:
+    // Creates the journal; throws std::runtime_error if it cannot be opened.
+    CheckpointWriter(const std::string& filename, MPI_File data, int n, double interval_seconds);
+    ~CheckpointWriter();
+    CheckpointWriter(const CheckpointWriter&) = delete;
+    CheckpointWriter& operator=(const CheckpointWriter&) = delete;
+
+    // Marks [first, first + count) as written, and flushes once interval_seconds passed since the last flush.
+    void add(Rank first, Rank count);
+    // Syncs data, then appends and syncs the pending entries.
+    void flush();
+
+private:
+    std::string filename_;
+    int fd_ = -1;
+    MPI_File data_;
+    std::chrono::steady_clock::duration interval_;
+    std::chrono::steady_clock::time_point last_flush_;
+    std::vector<CheckpointEntry> pending_;
+};
+
+#endif
@@ -0,0 +1,149 @@
+#include "ist_file.hpp"
+#include "../utils/instrumentation.hpp"
+#include "../utils/logging.hpp"
+#include <fstream>
+#include <stdexcept>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+IstFileHeader make_ist_header(int n) {
+    IstFileHeader header;
+    std::memcpy(header.magic, kIstMagic, sizeof(header.magic));
+    header.version = kIstVersion;
+    header.n = n;
+    header.num_trees = n - 1;
+    header.record_size = static_cast<std::uint32_t>(ist_record_size(n));
+    header.num_vertices = factorial(n);
+    return header;
+}
+
+std::string ist_binary_path(const std::string& output_dir, int n) {
+    return output_dir + "ists_B" + std::to_string(n) + ".ist";
+}
+
+std::string ist_text_path(const std::string& output_dir, int n) {
+    return output_dir + "ists_B" + std::to_string(n) + ".txt";
+}
+
+int swap_position_between(Rank v, Rank parent, int n) {
+    if (parent < 0) {
+        return 0;
+    }
+    // Neighbors differ in exactly two adjacent nibbles; the lower one is the swap
+    std::uint64_t diff = Permutation::unrank(v, n).word() ^ Permutation::unrank(parent, n).word();
+    return __builtin_ctzll(diff) / 4 + 1;
+}
+
+void encode_ist_record(Rank v, const int* parents, int n, unsigned char* record) {
+    int swaps[Permutation::kMaxSize];
+    for (int t = 1; t <= n - 1; ++t) {
+        swaps[t - 1] = swap_position_between(v, parents[t - 1], n);
+    }
+    encode_ist_swaps(swaps, n, record);
+}
+
+void encode_ist_swaps(const int* swaps, int n, unsigned char* record) {
+    std::memset(record, 0, ist_record_size(n));
+    for (int t = 1; t <= n - 1; ++t) {
+        record[(t - 1) / 2] |= static_cast<unsigned char>(swaps[t - 1] << (4 * ((t - 1) % 2)));
+    }
+}
+
+IstTextLayout::IstTextLayout(int n_) : n(n_), num_vertices(factorial(n_)) {
+    line_size = prefix.size() + n + middle.size() + n + 1;
+}
+
+std::string IstTextLayout::header(int t) const {
+    return "Tree T_" + std::to_string(t) + "^" + std::to_string(n) + ":\n";
+}
+
+std::int64_t IstTextLayout::tree_offset(int t) const {
+    std::int64_t offset = 0;
+    for (int s = 1; s < t; ++s) {
+        offset += header(s).size() + (num_vertices - 1) * line_size + 1;
+    }
+    return offset;
+}
+
+std::string IstTextLayout::blank_line() const {
+    return prefix + std::string(n, ' ') + middle + std::string(n, ' ') + "\n";
+}
+
+void IstTextLayout::format_line(char* line, Rank v, Rank parent) const {
+    Permutation::unrank(v, n).to_chars(line + prefix.size());
+    Permutation::unrank(parent, n).to_chars(line + prefix.size() + n + middle.size());
+}
+
+IstFileReader::IstFileReader(const std::string& filename) {
+    int fd = open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_ERROR("Failed to open IST file: " + filename);
+        throw std::runtime_error("Cannot open IST file: " + filename);
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(IstFileHeader)) {
+        close(fd);
+        LOG_ERROR("IST file too small: " + filename);
+        throw std::runtime_error("Invalid IST file: " + filename);
+    }
+    length_ = st.st_size;
+    data_ = mmap(nullptr, length_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (data_ == MAP_FAILED) {
+        data_ = nullptr;
+        LOG_ERROR("Failed to map IST file: " + filename);
+        throw std::runtime_error("Cannot map IST file: " + filename);
+    }
+
+    IstFileHeader header;
+    std::memcpy(&header, data_, sizeof(header));
+    if (std::memcmp(header.magic, kIstMagic, sizeof(header.magic)) != 0 || header.version != kIstVersion ||
+        header.n < 2 || header.n > static_cast<std::uint32_t>(Permutation::kMaxSize) ||
+        header.num_trees != header.n - 1 || header.record_size != ist_record_size(header.n) ||
+        header.num_vertices != static_cast<std::uint64_t>(factorial(header.n)) ||
+        length_ != sizeof(IstFileHeader) + header.num_vertices * header.record_size) {
+        munmap(data_, length_);
+        data_ = nullptr;
+        LOG_ERROR("Invalid IST file header: " + filename);
+        throw std::runtime_error("Invalid IST file: " + filename);
+    }
+    n_ = header.n;
+    num_trees_ = header.num_trees;
+    record_size_ = header.record_size;
+    num_vertices_ = header.num_vertices;
+    records_ = static_cast<const unsigned char*>(data_) + sizeof(IstFileHeader);
+}
+
+IstFileReader::~IstFileReader() {
+    if (data_ != nullptr) {
+        munmap(data_, length_);
+    }
+}
+
+void IstFileReader::export_text(const std::string& filename) const {
+    ScopedTimer timer("export_text");
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        LOG_ERROR("Failed to open output file: " + filename);
+        throw std::runtime_error("Cannot open output file: " + filename);
+    }
+    IstTextLayout layout(n_);
+    std::string line = layout.blank_line();
+    for (int t = 1; t <= num_trees_; ++t) {
+        out << layout.header(t);
+        for (Rank v = 0; v < num_vertices_; ++v) {
+            Rank p = parent(v, t);
+            if (p != -1) {
+                layout.format_line(&line[0], v, p);
+                out.write(line.data(), line.size());
+            }
+        }
+        out << "\n";
+    }
+    prof_count(ProfCounter::BytesWritten, out.tellp());
+    out.close();
+    LOG_INFO("Text export written to " + filename);
+}
@@ -0,0 +1,98 @@
+#ifndef IST_FILE_HPP
+#define IST_FILE_HPP
+
+#include "../utils/permutation.hpp"
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Binary IST file (.ist), indexed by permutation rank:
+//   IstFileHeader, then one record per vertex in rank order.
+// A record holds one 4-bit nibble per tree (tree t in nibble t-1, low nibble
+// first): the 1-based position p whose swap (p, p+1) gives the parent in T_t,
+// or 0 for the root. Fields are stored in native (little-endian) byte order.
+struct IstFileHeader {
+    char magic[8];               // kIstMagic
+    std::uint32_t version;       // kIstVersion
+    std::uint32_t n;             // Dimension of B_n
+    std::uint32_t num_trees;     // n - 1
+    std::uint32_t record_size;   // Bytes per vertex record
+    std::uint64_t num_vertices;  // n!
+};
+
+static_assert(sizeof(IstFileHeader) == 32, "IstFileHeader must have no padding");
+
+constexpr char kIstMagic[8] = {'B', 'S', 'I', 'S', 'T', '\0', '\0', '\0'};
+constexpr std::uint32_t kIstVersion = 1;
+
+IstFileHeader make_ist_header(int n);
+inline std::size_t ist_record_size(int n) { return static_cast<std::size_t>(n) / 2; } // ceil((n - 1) / 2)
+std::string ist_binary_path(const std::string& output_dir, int n);
+std::string ist_text_path(const std::string& output_dir, int n);
+
+// Swap position taking the vertex of rank v to its neighbor of rank parent
+// (0 when parent is -1).
+int swap_position_between(Rank v, Rank parent, int n);
+// Encodes a vertex's parents (ranks, -1 for the root) into record_size bytes.
+void encode_ist_record(Rank v, const int* parents, int n, unsigned char* record);
+// Same, from the swap positions produced by parent_swap_positions.
+void encode_ist_swaps(const int* swaps, int n, unsigned char* record);
+
+// Fixed-width layout of the text export, so the byte offset of every line can
+// be computed without writing the lines before it. Each tree is a header, one
+// "Vertex <v> -> Parent <p>" line per non-root vertex in rank order, and a
+// blank line.
+struct IstTextLayout {
+    int n;
+    Rank num_vertices;
+    std::string prefix = "Vertex ";
+    std::string middle = " -> Parent ";
+    std::int64_t line_size;
+
+    explicit IstTextLayout(int n_);
+    std::string header(int t) const;
+    std::int64_t tree_offset(int t) const;
+    std::int64_t line_offset(int t, Rank v) const { return tree_offset(t) + header(t).size() + (v - 1) * line_size; }
+    std::int64_t file_size() const { return tree_offset(n); }
+    std::string blank_line() const; // Line with the permutation fields left blank
+    void format_line(char* line, Rank v, Rank parent) const;
+};
+
+// Read-only memory map of an .ist file; lookups touch only the record bytes.
+class IstFileReader {
+public:
+    explicit IstFileReader(const std::string& filename);
+    ~IstFileReader();
+    IstFileReader(const IstFileReader&) = delete;
+    IstFileReader& operator=(const IstFileReader&) = delete;
+
+    int dimension() const { return n_; }
+    int num_trees() const { return num_trees_; }
+    Rank num_vertices() const { return num_vertices_; }
+
+    // Parent swap position of v in T_t (t is 1-based), 0 for the root
+    int swap_position(Rank v, int t) const {
+        unsigned char byte = records_[v * record_size_ + (t - 1) / 2];
+        return (t - 1) % 2 == 0 ? (byte & 0xF) : (byte >> 4);
+    }
+    // Parent rank of v in T_t, -1 for the root
+    Rank parent(Rank v, int t) const {
+        int p = swap_position(v, t);
+        return p == 0 ? -1 : adjacent_rank(v, n_, p);
+    }
+
+    // Writes the text format produced by output_ists
+    void export_text(const std::string& filename) const;
+
+private:
+    void* data_ = nullptr;
+    std::size_t length_ = 0;
+    const unsigned char* records_ = nullptr;
+    int n_ = 0;
+    int num_trees_ = 0;
+    std::size_t record_size_ = 0;
+    Rank num_vertices_ = 0;
+};
+
+#endif
@@ -0,0 +1,100 @@
+#include "partition_cache.hpp"
+#include "../utils/logging.hpp"
+#include "../utils/permutation.hpp"
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+std::string partition_cache_path(const std::string& cache_dir, int n, int nparts, std::uint64_t options_key) {
+    std::ostringstream path;
+    path << cache_dir << "partition_B" << n << "_k" << nparts << "_" << std::hex << options_key << ".part";
+    return path.str();
+}
+
+std::unique_ptr<PartitionCacheReader> PartitionCacheReader::open(const std::string& filename, int n, int nparts,
+                                                                 std::uint64_t options_key) {
+    int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG_INFO("No cached partition at " + filename);
+        return nullptr;
+    }
+    struct stat st;
+    if (fstat(fd, &st) != 0 || static_cast<std::size_t>(st.st_size) < sizeof(PartitionCacheHeader)) {
+        close(fd);
+        LOG_INFO("Ignoring truncated partition cache " + filename);
+        return nullptr;
+    }
+    std::unique_ptr<PartitionCacheReader> reader(new PartitionCacheReader());
+    reader->length_ = st.st_size;
+    reader->data_ = mmap(nullptr, reader->length_, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (reader->data_ == MAP_FAILED) {
+        reader->data_ = nullptr;
+        LOG_ERROR("Failed to map partition cache: " + filename);
+        return nullptr;
+    }
+
+    PartitionCacheHeader header;
+    std::memcpy(&header, reader->data_, sizeof(header));
+    const std::uint64_t num_vertices = static_cast<std::uint64_t>(factorial(n));
+    if (std::memcmp(header.magic, kPartitionCacheMagic, sizeof(header.magic)) != 0 ||
+        header.version != kPartitionCacheVersion || header.n != static_cast<std::uint32_t>(n) ||
+        header.nparts != static_cast<std::uint32_t>(nparts) || header.idx_width != sizeof(idx_t) ||
+        header.options_key != options_key || header.num_vertices != num_vertices ||
+        reader->length_ != sizeof(PartitionCacheHeader) + num_vertices * sizeof(idx_t)) {
+        LOG_INFO("Ignoring partition cache with a different key or layout: " + filename);
+        return nullptr;
+    }
+    reader->parts_ = reinterpret_cast<const idx_t*>(static_cast<const char*>(reader->data_) + sizeof(PartitionCacheHeader));
+    reader->num_vertices_ = num_vertices;
+    for (std::size_t v = 0; v < reader->num_vertices_; ++v) {
+        if (reader->parts_[v] < 0 || reader->parts_[v] >= nparts) {
+            LOG_ERROR("Corrupt partition cache (part " + std::to_string(reader->parts_[v]) + " at vertex " +
+                      std::to_string(v) + "): " + filename);
+            return nullptr;
+        }
+    }
+    return reader;
+}
+
+PartitionCacheReader::~PartitionCacheReader() {
+    if (data_ != nullptr) {
+        munmap(data_, length_);
+    }
+}
+
+bool write_partition_cache(const std::string& filename, int n, int nparts, std::uint64_t options_key,
+                           const std::vector<idx_t>& parts) {
+    PartitionCacheHeader header;
+    std::memcpy(header.magic, kPartitionCacheMagic, sizeof(header.magic));
+    header.version = kPartitionCacheVersion;
+    header.n = n;
+    header.nparts = nparts;
+    header.idx_width = sizeof(idx_t);
+    header.options_key = options_key;
+    header.num_vertices = parts.size();
+
+    const std::string temporary = filename + ".tmp" + std::to_string(getpid());
+    {
+        std::ofstream out(temporary, std::ios::binary);
+        out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+        out.write(reinterpret_cast<const char*>(parts.data()), parts.size() * sizeof(idx_t));
+        if (!out) {
+            LOG_ERROR("Failed to write partition cache: " + temporary);
+            std::remove(temporary.c_str());
+            return false;
+        }
+    }
+    if (std::rename(temporary.c_str(), filename.c_str()) != 0) {
+        LOG_ERROR("Failed to move partition cache into place: " + filename);
+        std::remove(temporary.c_str());
+        return false;
+    }
+    LOG_INFO("Partition cached at " + filename);
+    return true;
+}
@@ -0,0 +1,58 @@
+#ifndef PARTITION_CACHE_HPP
+#define PARTITION_CACHE_HPP
+
+#include <cstdint>
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <vector>
+#include <metis.h>
+
+// On-disk METIS partition, one file per (n, nparts, METIS settings):
+//   PartitionCacheHeader, then num_vertices idx_t part numbers in rank order.
+// Native byte order; a file written with a different idx_t width is ignored.
+struct PartitionCacheHeader {
+    char magic[8];               // kPartitionCacheMagic
+    std::uint32_t version;       // kPartitionCacheVersion
+    std::uint32_t n;             // Dimension of B_n
+    std::uint32_t nparts;
+    std::uint32_t idx_width;     // sizeof(idx_t)
+    std::uint64_t options_key;   // Hash of the METIS options (see partition_graph)
+    std::uint64_t num_vertices;  // n!
+};
+
+static_assert(sizeof(PartitionCacheHeader) == 40, "PartitionCacheHeader must have no padding");
+
+constexpr char kPartitionCacheMagic[8] = {'B', 'S', 'P', 'A', 'R', 'T', '\0', '\0'};
+constexpr std::uint32_t kPartitionCacheVersion = 1;
+
+std::string partition_cache_path(const std::string& cache_dir, int n, int nparts, std::uint64_t options_key);
+
+// Read-only memory map of a cached partition.
+class PartitionCacheReader {
+public:
+    // Null if the file is missing, malformed, or was written for another key.
+    static std::unique_ptr<PartitionCacheReader> open(const std::string& filename, int n, int nparts,
+                                                      std::uint64_t options_key);
+    ~PartitionCacheReader();
+    PartitionCacheReader(const PartitionCacheReader&) = delete;
+    PartitionCacheReader& operator=(const PartitionCacheReader&) = delete;
+
+    const idx_t* parts() const { return parts_; }
+    std::size_t size() const { return num_vertices_; }
+
+private:
+    PartitionCacheReader() = default;
+
+    void* data_ = nullptr;
+    std::size_t length_ = 0;
+    const idx_t* parts_ = nullptr;
+    std::size_t num_vertices_ = 0;
+};
+
+// Writes through a temporary file and rename(), so concurrent runs never map
+// a partial file. Returns false (after logging) on I/O errors.
+bool write_partition_cache(const std::string& filename, int n, int nparts, std::uint64_t options_key,
+                           const std::vector<idx_t>& parts);
+
+#endif
@@ -1,84 +1,240 @@
 #include <mpi.h>
+#include <omp.h>
 #include <iostream>
 #include <filesystem>
+#include <numeric>
+#include <stdexcept>
 #include "graph/bubble_sort_graph.hpp"
+#include "io/ist_file.hpp"
+#include "algorithm/ist_batch.hpp"
 #include "algorithm/ist_construct.hpp"
+#include "parallel/ist_verify.hpp"
 #include "parallel/metis_partition.hpp"
 #include "parallel/mpi_utils.hpp"
 #include "parallel/openmp_utils.hpp"
+#include "parallel/prefix_partition.hpp"
+#include "parallel/streaming.hpp"
+#include "utils/config.hpp"
+#include "utils/instrumentation.hpp"
 #include "utils/logging.hpp"
+#include "utils/run_report.hpp"
 
 int main(int argc, char* argv[]) {
-    MPI_Init(&argc, &argv);
+    // OpenMP and pipeline threads never call MPI; only the main thread does
+    int provided;
+    MPI_Init_thread(&argc, &argv, MPI_THREAD_FUNNELED, &provided);
+    log_init();
 
     int rank, size;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
     MPI_Comm_size(MPI_COMM_WORLD, &size);
+    if (provided < MPI_THREAD_FUNNELED) {
+        // Even the unstreamed path runs OpenMP threads next to MPI
+        if (rank == 0) {
+            LOG_ERROR("The MPI library does not support MPI_THREAD_FUNNELED (provided level " + std::to_string(provided) + ").");
+        }
+        log_shutdown();
+        MPI_Abort(MPI_COMM_WORLD, 1);
+    }
 
     // Configuration
-    const int n = 7; // Dimension of B_n (test with B_4)
-    const std::string output_dir = "data/output/";
+    Config config;
+    try {
+        config = parse_config(argc, argv);
+    } catch (const std::invalid_argument& e) {
+        if (rank == 0) {
+            std::cerr << e.what() << "\n" << config_usage(argv[0]);
+        }
+        log_shutdown();
+        MPI_Finalize();
+        return 2;
+    }
+    if (config.help) {
+        if (rank == 0) {
+            std::cout << config_usage(argv[0]);
+        }
+        log_shutdown();
+        MPI_Finalize();
+        return 0;
+    }
+    prof_init(config.profile);
+    if (config.threads > 0) {
+        omp_set_num_threads(config.threads);
+    }
+    set_loop_schedule(config.schedule, config.chunk);
+    set_thread_binding(config.bind);
+    pin_omp_threads();
+    const int n = config.n;
+    const std::string& output_dir = config.output_dir;
+    // Range and prefix partitions are contiguous rank ranges: no graph, no METIS
+    const bool distributed = config.partition != PartitionStrategy::Metis;
+    const bool streamed = distributed && config.binary_output() && config.streaming;
 
-    double start_time, graph_time, partition_time, local_vertices_time, ist_time, gather_time, output_time;
+    int exit_code = 0;
+    bool verified = false;
+    double start_time = 0.0, graph_time = 0.0, partition_time = 0.0, local_vertices_time = 0.0, ist_time = 0.0,
+           gather_time = 0.0, output_time = 0.0, verify_time = 0.0;
 
     if (rank == 0) {
         start_time = MPI_Wtime();
-        log_info("Starting IST construction for B_" + std::to_string(n) + " with " + std::to_string(size) + " MPI processes.");
+        LOG_INFO("Starting IST construction for B_" + std::to_string(n) + " with " + std::to_string(size) +
+                 " MPI processes and " + std::to_string(omp_get_max_threads()) + " OpenMP threads (SIMD: " + to_string(simd_level()) + ").");
         std::filesystem::create_directories(output_dir);
-        log_info("Output directory " + output_dir + " ensured.");
+        LOG_INFO("Output directory " + output_dir + " ensured.");
     }
 
-    // Create bubble-sort network
-    BubbleSortGraph graph(n);
-    if (rank == 0) {
-        graph_time = MPI_Wtime();
-        log_info("Rank " + std::to_string(rank) + ": Graph created with " + std::to_string(graph.num_vertices()) + " vertices.");
-    }
+    const int num_vertices = static_cast<int>(factorial(n));
+    ParentTable parents;
+    std::vector<int> local_vertices;
+    MetisPartition metis;
+    PartitionQuality partition_quality; // Rank 0, when the strategy measures it
 
-    // Partition vertices using METIS
-    std::vector<idx_t> partition = partition_graph(graph, size);
-    if (rank == 0) {
-        partition_time = MPI_Wtime();
-        log_info("Rank " + std::to_string(rank) + ": Partitioning completed, partition size = " + std::to_string(partition.size()));
-    }
+    if (distributed) {
+        // No graph and no partitioner: neighbor and parent ranks are computed arithmetically
+        if (rank == 0) {
+            graph_time = MPI_Wtime();
+        }
+        std::pair<Rank, Rank> range;
+        if (config.partition == PartitionStrategy::Prefix) {
+            // Every rank derives the same partition from n and size alone
+            PrefixPartition prefix(n, size, kImbalanceTolerance);
+            range = prefix.range(rank);
+            if (rank == 0) {
+                partition_quality = prefix.quality();
+                LOG_INFO("Rank 0: Prefix partition with " + std::to_string(prefix.num_classes()) + " classes of length " +
+                         std::to_string(prefix.prefix_length()) + ": " + partition_quality.describe());
+            }
+        } else {
+            range = local_rank_range(num_vertices, rank, size);
+        }
+        if (rank == 0) {
+            partition_time = local_vertices_time = MPI_Wtime();
+            LOG_INFO("Rank " + std::to_string(rank) + ": Assigned ranks [" + std::to_string(range.first) + ", " +
+                     std::to_string(range.second) + ").");
+        }
+        if (streamed) {
+            // Construction and output overlap, so the IST time below includes the binary write
+            MPI_Barrier(MPI_COMM_WORLD); // The output directory must exist before the collective open
+            if (config.checkpoint_dir.empty()) {
+                stream_ists_binary({range}, n, output_dir);
+            } else {
+                // Work is split by what is left, so the rank count may change between runs
+                ResumePlan plan = plan_checkpointed_run(config.checkpoint_dir, output_dir, n, config.resume);
+                StreamCheckpoint checkpoint{config.checkpoint_dir, plan.generation, static_cast<double>(config.checkpoint_interval)};
+                stream_ists_binary(split_ranges(plan.missing, rank, size), n, output_dir, &checkpoint);
+            }
+        } else {
+            local_vertices.resize(range.second - range.first);
+            std::iota(local_vertices.begin(), local_vertices.end(), static_cast<int>(range.first));
+            parents = construct_ists_range(range.first, range.second, n);
+        }
+    } else {
+        // Construction only needs vertex ranks; the explicit graph is built by
+        // rank 0 inside partition_vertices, and only when no partition is cached
+        BubbleSortGraph graph(n, GraphMode::Implicit);
+        if (rank == 0) {
+            graph_time = MPI_Wtime();
+        }
 
-    // Get local vertices for this process
-    std::vector<int> local_vertices = get_local_vertices(partition, rank, size, graph.num_vertices());
-    if (rank == 0) {
-        local_vertices_time = MPI_Wtime();
-        log_info("Rank " + std::to_string(rank) + ": Assigned " + std::to_string(local_vertices.size()) + " local vertices.");
-    }
+        // Partition vertices using METIS on rank 0 and receive this rank's share
+        metis = partition_vertices(n, size, config.partition_cache);
+        local_vertices = std::move(metis.local_vertices);
+        if (rank == 0) {
+            partition_quality = metis.quality;
+            partition_time = local_vertices_time = MPI_Wtime();
+            LOG_INFO("Rank " + std::to_string(rank) + ": Partitioning completed, assigned " +
+                     std::to_string(local_vertices.size()) + " local vertices.");
+        }
 
-    // Construct ISTs in parallel
-    std::vector<std::vector<int>> parents = construct_ists_parallel(graph, local_vertices, n);
+        // Construct ISTs in parallel
+        parents = construct_ists_parallel(graph, local_vertices, n);
+    }
     if (rank == 0) {
         ist_time = MPI_Wtime();
-        log_info("Rank " + std::to_string(rank) + ": Local IST construction completed, parents size = " + std::to_string(parents.size()));
+        LOG_INFO("Rank " + std::to_string(rank) + ": Local IST construction completed, parents size = " + std::to_string(parents.size()));
     }
 
-    // Gather and output results
-    if (rank == 0) {
-        std::vector<std::vector<int>> all_parents = gather_parents(parents, local_vertices, partition, size, graph.num_vertices(), n);
-        gather_time = MPI_Wtime();
-        log_info("Rank 0: Gathered all parents, size = " + std::to_string(all_parents.size()));
-        output_ists(graph, all_parents, n, output_dir);
-        output_time = MPI_Wtime();
-        log_info("IST construction completed. Results written to " + output_dir + "ists_B" + std::to_string(n) + ".txt");
-        log_info("Timing: Graph=" + std::to_string(graph_time - start_time) +
-                 "s, Partition=" + std::to_string(partition_time - graph_time) +
-                 "s, LocalVertices=" + std::to_string(local_vertices_time - partition_time) +
-                 "s, IST=" + std::to_string(ist_time - local_vertices_time) +
-                 "s, Gather=" + std::to_string(gather_time - ist_time) +
-                 "s, Output=" + std::to_string(output_time - gather_time) +
-                 "s, Total=" + std::to_string(output_time - start_time) + "s");
+    const bool gather = !config.binary_output() && config.text_writer == TextWriter::Gather;
+    if (!gather) {
+        // The output directory must exist before the collective open
+        MPI_Barrier(MPI_COMM_WORLD);
+        if (rank == 0) {
+            gather_time = MPI_Wtime();
+        }
+    }
+    if (config.binary_output()) {
+        if (!streamed) {
+            output_ists_binary(local_vertices, parents, n, output_dir);
+        }
+        if (config.text_output()) {
+            // All records must be on disk before rank 0 maps the file
+            MPI_Barrier(MPI_COMM_WORLD);
+            if (rank == 0) {
+                IstFileReader reader(ist_binary_path(output_dir, n));
+                reader.export_text(ist_text_path(output_dir, n));
+            }
+        }
+    } else if (!gather) {
+        output_ists_mpiio(local_vertices, parents, n, output_dir);
     } else {
-        gather_parents(parents, local_vertices, partition, size, graph.num_vertices(), n);
+        // Gather and output results
+        ParentTable all_parents = distributed
+            ? gather_parents_range(parents, size, num_vertices, n)
+            : gather_parents(parents, metis.parts(), size, num_vertices, n);
         if (rank == 0) {
             gather_time = MPI_Wtime();
-            log_info("Rank " + std::to_string(rank) + ": Gather parents completed.");
+            LOG_INFO("Rank 0: Gathered all parents, size = " + std::to_string(all_parents.size()));
+            output_ists(all_parents, n, output_dir);
+        }
+    }
+    if (rank == 0) {
+        output_time = MPI_Wtime();
+    }
+
+    if (config.binary_output() && config.verify) {
+        MPI_Barrier(MPI_COMM_WORLD);
+        IstFileReader reader(ist_binary_path(output_dir, n));
+        IstVerifyResult result = verify_ists(reader);
+        verified = result.ok();
+        if (!verified) {
+            exit_code = 1;
+            if (rank == 0) {
+                LOG_ERROR("IST verification failed: " + result.describe(n));
+            }
+        }
+    } else if (config.verify && rank == 0) {
+        // The verifier maps the .ist file, which text-only runs do not write
+        LOG_INFO("IST verification skipped: --format text writes no .ist file; use --format both to verify.");
+    }
+
+    if (rank == 0) {
+        verify_time = MPI_Wtime();
+        LOG_INFO("IST construction completed. Results written to " +
+                 (config.binary_output() ? ist_binary_path(output_dir, n) : ist_text_path(output_dir, n)));
+        RunTimings timings;
+        timings.graph = graph_time - start_time;
+        timings.partition = partition_time - graph_time;
+        timings.local_vertices = local_vertices_time - partition_time;
+        timings.ist = ist_time - local_vertices_time;
+        timings.gather = gather_time - ist_time;
+        timings.output = output_time - gather_time;
+        timings.verify = verify_time - output_time;
+        timings.total = verify_time - start_time;
+        LOG_INFO("Timing: Graph=" + std::to_string(timings.graph) +
+                 "s, Partition=" + std::to_string(timings.partition) +
+                 "s, LocalVertices=" + std::to_string(timings.local_vertices) +
+                 "s, IST=" + std::to_string(timings.ist) +
+                 "s, Gather=" + std::to_string(timings.gather) +
+                 "s, Output=" + std::to_string(timings.output) +
+                 "s, Verify=" + std::to_string(timings.verify) +
+                 "s, Total=" + std::to_string(timings.total) + "s");
+        if (!config.report.empty()) {
+            append_run_report(config.report, config, size, omp_get_max_threads(), timings, partition_quality, verified);
         }
     }
 
+    prof_report(config.trace);
+    log_shutdown();
     MPI_Finalize();
-    return 0;
-}
\ No newline at end of file
+    return exit_code;
+}
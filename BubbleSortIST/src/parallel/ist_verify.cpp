@@ -0,0 +1,173 @@
+#include "ist_verify.hpp"
+#include "mpi_utils.hpp"
+#include "../utils/instrumentation.hpp"
+#include "../utils/logging.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+#include <mpi.h>
+#include <omp.h>
+
+namespace {
+
+constexpr std::int64_t kNoViolation = std::numeric_limits<std::int64_t>::max();
+
+// Orders violations by vertex first, so a MIN reduction yields the first one
+std::int64_t encode(IstViolationKind kind, Rank v, int tree, int other_tree) {
+    return (v << 12) | (static_cast<std::int64_t>(kind) << 8) | (tree << 4) | other_tree;
+}
+
+IstVerifyResult decode(std::int64_t key) {
+    IstVerifyResult result;
+    if (key == kNoViolation) {
+        return result;
+    }
+    result.vertex = key >> 12;
+    result.kind = static_cast<IstViolationKind>((key >> 8) & 0xF);
+    result.tree = static_cast<int>((key >> 4) & 0xF);
+    result.other_tree = static_cast<int>(key & 0xF);
+    return result;
+}
+
+std::int64_t global_min(std::int64_t local) {
+    std::int64_t global;
+    MPI_Allreduce(&local, &global, 1, MPI_INT64_T, MPI_MIN, MPI_COMM_WORLD);
+    return global;
+}
+
+// Root-structure and swap-range checks, then pointer jumping: after
+// ceil(log2 N) squarings anc[v] is v's 2^k-th ancestor (the root is its own
+// parent), which is the root exactly when v's path reaches it.
+std::int64_t check_spanning(const IstFileReader& reader, int t) {
+    const int n = reader.dimension();
+    const Rank num_vertices = reader.num_vertices();
+    std::vector<std::uint32_t> anc(num_vertices), next(num_vertices);
+    std::int64_t first = kNoViolation;
+
+    #pragma omp parallel for reduction(min : first)
+    for (Rank v = 0; v < num_vertices; ++v) {
+        int p = reader.swap_position(v, t);
+        if ((v == 0) != (p == 0)) {
+            first = std::min(first, encode(IstViolationKind::BadRoot, v, t, 0));
+        } else if (p > n - 1) {
+            first = std::min(first, encode(IstViolationKind::BadSwap, v, t, 0));
+        }
+        anc[v] = p == 0 || p > n - 1 ? 0 : static_cast<std::uint32_t>(adjacent_rank(v, n, p));
+    }
+    if (first != kNoViolation) {
+        return first;
+    }
+
+    for (Rank steps = 1; steps < num_vertices; steps *= 2) {
+        #pragma omp parallel for
+        for (Rank v = 0; v < num_vertices; ++v) {
+            next[v] = anc[anc[v]];
+        }
+        anc.swap(next);
+    }
+
+    #pragma omp parallel for reduction(min : first)
+    for (Rank v = 0; v < num_vertices; ++v) {
+        if (anc[v] != 0) {
+            first = std::min(first, encode(IstViolationKind::NotSpanning, v, t, 0));
+        }
+    }
+    return first;
+}
+
+// Walks the n-1 root paths of every vertex in [begin, end). Internal
+// vertices are marked in a per-thread bitset and unmarked afterwards, so
+// each vertex costs only the total length of its paths.
+std::int64_t check_independence(const IstFileReader& reader, Rank begin, Rank end) {
+    const int n = reader.dimension();
+    const Rank num_vertices = reader.num_vertices();
+    std::int64_t first = kNoViolation;
+
+    #pragma omp parallel reduction(min : first)
+    {
+        std::vector<std::uint64_t> marked((num_vertices + 63) / 64, 0);
+        std::vector<std::pair<Rank, int>> path; // (internal vertex, tree)
+
+        #pragma omp for schedule(dynamic, 1024)
+        for (Rank v = begin; v < end; ++v) {
+            if (v == 0 || (v << 12) >= first) {
+                continue;
+            }
+            path.clear();
+            std::int64_t violation = kNoViolation;
+            for (int t = 1; t <= n - 1 && violation == kNoViolation; ++t) {
+                for (Rank u = reader.parent(v, t); u != 0; u = reader.parent(u, t)) {
+                    std::uint64_t bit = std::uint64_t{1} << (u % 64);
+                    if (marked[u / 64] & bit) {
+                        int other = std::find_if(path.begin(), path.end(),
+                                                 [u](const std::pair<Rank, int>& e) { return e.first == u; })->second;
+                        violation = encode(IstViolationKind::NotIndependent, v, other, t);
+                        break;
+                    }
+                    marked[u / 64] |= bit;
+                    path.emplace_back(u, t);
+                }
+            }
+            for (const auto& entry : path) {
+                marked[entry.first / 64] &= ~(std::uint64_t{1} << (entry.first % 64));
+            }
+            first = std::min(first, violation);
+        }
+    }
+    return first;
+}
+
+} // namespace
+
+std::string IstVerifyResult::describe(int n) const {
+    if (ok()) {
+        return "all " + std::to_string(n - 1) + " trees are independent spanning trees";
+    }
+    std::string where = "vertex " + Permutation::unrank(vertex, n).to_string() + " (rank " + std::to_string(vertex) +
+                        ") in T_" + std::to_string(tree);
+    switch (kind) {
+    case IstViolationKind::None:
+        break;
+    case IstViolationKind::BadRoot:
+        return where + ": only the identity may be (and must be) the root";
+    case IstViolationKind::BadSwap:
+        return where + ": swap position out of range";
+    case IstViolationKind::NotSpanning:
+        return where + ": root path does not reach the identity";
+    case IstViolationKind::NotIndependent:
+        return where + ": root path meets the path in T_" + std::to_string(other_tree);
+    }
+    return where;
+}
+
+IstVerifyResult verify_ists(const IstFileReader& reader) {
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+    const int n = reader.dimension();
+
+    std::int64_t local = kNoViolation;
+    {
+        ScopedTimer spanning_timer("verify_spanning");
+        for (int t = 1 + rank; t <= reader.num_trees(); t += size) {
+            local = std::min(local, check_spanning(reader, t));
+        }
+    }
+    IstVerifyResult result = decode(global_min(local));
+    LOG_INFO("Rank " + std::to_string(rank) + ": Spanning check completed.");
+
+    // Root paths are only well defined once every tree is spanning
+    if (result.ok()) {
+        ScopedTimer independence_timer("verify_independence");
+        std::pair<Rank, Rank> range = local_rank_range(reader.num_vertices(), rank, size);
+        result = decode(global_min(check_independence(reader, range.first, range.second)));
+        LOG_INFO("Rank " + std::to_string(rank) + ": Independence check completed for ranks [" +
+                 std::to_string(range.first) + ", " + std::to_string(range.second) + ").");
+    }
+    if (rank == 0) {
+        LOG_INFO("Verification of B_" + std::to_string(n) + ": " + result.describe(n));
+    }
+    return result;
+}
@@ -0,0 +1,32 @@
+#ifndef IST_VERIFY_HPP
+#define IST_VERIFY_HPP
+
+#include "../io/ist_file.hpp"
+#include <string>
+
+enum class IstViolationKind {
+    None,
+    BadRoot,        // Identity has a parent, or another vertex has none
+    BadSwap,        // Swap position outside 1..n-1
+    NotSpanning,    // Root path does not reach the identity (cycle)
+    NotIndependent, // Two root paths share an internal vertex
+};
+
+struct IstVerifyResult {
+    IstViolationKind kind = IstViolationKind::None;
+    Rank vertex = -1;    // First violating vertex (smallest rank)
+    int tree = 0;        // Tree of the violation (1-based)
+    int other_tree = 0;  // NotIndependent: the tree whose path meets tree's path
+    bool ok() const { return kind == IstViolationKind::None; }
+    std::string describe(int n) const;
+};
+
+// Checks that T_1..T_{n-1} in the file are spanning trees rooted at the
+// identity whose root paths are pairwise internally vertex-disjoint.
+// Spanning: trees are dealt round-robin to ranks and each is resolved by
+// parent-pointer jumping with OpenMP. Independence: each rank walks the n-1
+// root paths of its own vertex range, marking them in a per-thread bitset.
+// Collective over MPI_COMM_WORLD; every rank gets the first violation.
+IstVerifyResult verify_ists(const IstFileReader& reader);
+
+#endif
@@ -1,44 +1,70 @@
 #include "metis_partition.hpp"
+#include "../utils/instrumentation.hpp"
 #include "../utils/logging.hpp"
 #include <metis.h>
 #include <mpi.h>
 #include <omp.h>
+#include <cstring>
+#include <filesystem>
 #include <stdexcept>
 #include <sstream>
 
+namespace {
+
+void set_metis_options(idx_t* options) {
+    METIS_SetDefaultOptions(options);
+    options[METIS_OPTION_PTYPE] = METIS_PTYPE_KWAY;
+    options[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
+    options[METIS_OPTION_NUMBERING] = 0; // C-style numbering
+    options[METIS_OPTION_NITER] = 10; // Number of iterations
+    options[METIS_OPTION_NCUTS] = 1; // Number of different partitions to compute
+}
+
+// FNV-1a over everything that changes the result besides n and nparts
+std::uint64_t metis_options_key() {
+    idx_t options[METIS_NOPTIONS];
+    set_metis_options(options);
+    std::uint64_t key = 14695981039346656037ull;
+    auto mix = [&key](const void* data, std::size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (std::size_t i = 0; i < size; ++i) {
+            key = (key ^ bytes[i]) * 1099511628211ull;
+        }
+    };
+    mix(options, sizeof(options));
+    mix(&kImbalanceTolerance, sizeof(kImbalanceTolerance));
+    return key;
+}
+
+} // namespace
+
 std::vector<idx_t> partition_graph(const BubbleSortGraph& graph, int nparts) {
+    ScopedTimer timer("partition_graph");
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    log_info("Rank " + std::to_string(rank) + ": Starting METIS partitioning for " + std::to_string(graph.num_vertices()) + " vertices, nparts = " + std::to_string(nparts));
+    LOG_INFO("Rank " + std::to_string(rank) + ": Starting METIS partitioning for " + std::to_string(graph.num_vertices()) + " vertices, nparts = " + std::to_string(nparts));
 
     // Handle single partition or small graphs
     if (nparts == 1 || graph.num_vertices() <= 2) {
-        log_info("Rank " + std::to_string(rank) + ": Single partition or small graph, assigning all vertices to rank 0.");
+        LOG_INFO("Rank " + std::to_string(rank) + ": Single partition or small graph, assigning all vertices to rank 0.");
         std::vector<idx_t> partition(graph.num_vertices(), 0);
         return partition;
     }
 
-    std::vector<idx_t> adjncy, xadj;
-    graph.to_metis_format(xadj, adjncy);
+    // Explicit graphs already hold METIS-ready CSR buffers; only implicit ones need a copy
+    std::vector<idx_t> owned_xadj, owned_adjncy;
+    if (graph.is_implicit()) {
+        graph.to_metis_format(owned_xadj, owned_adjncy);
+    }
+    const std::vector<idx_t>& xadj = graph.is_implicit() ? owned_xadj : graph.xadj();
+    const std::vector<idx_t>& adjncy = graph.is_implicit() ? owned_adjncy : graph.adjncy();
 
     // Validate xadj and adjncy
-    if (xadj.size() != graph.num_vertices() + 1) {
-        log_error("Invalid xadj size: " + std::to_string(xadj.size()) + ", expected " + std::to_string(graph.num_vertices() + 1));
+    if (xadj.size() != static_cast<size_t>(graph.num_vertices()) + 1 || static_cast<size_t>(xadj.back()) != adjncy.size()) {
+        LOG_ERROR("Invalid xadj size: " + std::to_string(xadj.size()) + ", expected " + std::to_string(graph.num_vertices() + 1));
         throw std::runtime_error("Invalid xadj size");
     }
-    for (size_t i = 0; i < xadj.size() - 1; ++i) {
-        if (xadj[i] > xadj[i + 1]) {
-            log_error("Invalid xadj: xadj[" + std::to_string(i) + "] = " + std::to_string(xadj[i]) + " > xadj[" + std::to_string(i + 1) + "] = " + std::to_string(xadj[i + 1]));
-            throw std::runtime_error("Invalid xadj array");
-        }
-    }
-    for (idx_t v : adjncy) {
-        if (v < 0 || v >= static_cast<idx_t>(graph.num_vertices())) {
-            log_error("Invalid adjncy vertex: " + std::to_string(v));
-            throw std::runtime_error("Invalid adjncy vertex");
-        }
-    }
-    log_info("Rank " + std::to_string(rank) + ": xadj = [" + [&xadj]() {
+    LOG_DEBUG("Rank " + std::to_string(rank) + ": xadj = [" + [&xadj]() {
         std::stringstream ss;
         for (idx_t x : xadj) ss << x << " ";
         return ss.str();
@@ -55,28 +81,82 @@ std::vector<idx_t> partition_graph(const BubbleSortGraph& graph, int nparts) {
 
     // Set METIS options
     idx_t options[METIS_NOPTIONS];
-    METIS_SetDefaultOptions(options);
-    options[METIS_OPTION_PTYPE] = METIS_PTYPE_KWAY;
-    options[METIS_OPTION_OBJTYPE] = METIS_OBJTYPE_CUT;
-    options[METIS_OPTION_NUMBERING] = 0; // C-style numbering
-    options[METIS_OPTION_NITER] = 10; // Number of iterations
-    options[METIS_OPTION_NCUTS] = 1; // Number of different partitions to compute
+    set_metis_options(options);
 
     // Compute target partition weights
     std::vector<real_t> tpwgts(nparts * ncon, 1.0 / nparts);
-    std::vector<real_t> ubvec(ncon, 1.05); // 5% imbalance tolerance
+    std::vector<real_t> ubvec(ncon, kImbalanceTolerance);
 
-    log_info("Rank " + std::to_string(rank) + ": METIS parameters: nvtxs = " + std::to_string(nvtxs) +
+    LOG_INFO("Rank " + std::to_string(rank) + ": METIS parameters: nvtxs = " + std::to_string(nvtxs) +
              ", ncon = " + std::to_string(ncon) + ", nparts = " + std::to_string(nparts));
 
-    // Call METIS
-    int ret = METIS_PartGraphKway(&nvtxs, &ncon, xadj.data(), adjncy.data(), nullptr, nullptr, nullptr,
+    // Call METIS; it does not modify xadj/adjncy, its API just is not const-qualified
+    int ret = METIS_PartGraphKway(&nvtxs, &ncon, const_cast<idx_t*>(xadj.data()), const_cast<idx_t*>(adjncy.data()), nullptr, nullptr, nullptr,
                                   &nparts, tpwgts.data(), ubvec.data(), options, &objval, part.data());
     if (ret != METIS_OK) {
-        log_error("METIS_PartGraphKway failed with return code " + std::to_string(ret));
+        LOG_ERROR("METIS_PartGraphKway failed with return code " + std::to_string(ret));
         throw std::runtime_error("METIS partitioning failed");
     }
 
-    log_info("Rank " + std::to_string(rank) + ": METIS partitioning completed, objval = " + std::to_string(objval));
+    LOG_INFO("Rank " + std::to_string(rank) + ": METIS partitioning completed, objval = " + std::to_string(objval));
     return part;
-}
\ No newline at end of file
+}
+
+MetisPartition partition_vertices(int n, int nparts, const std::string& cache_dir) {
+    ScopedTimer timer("partition_vertices");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const int num_vertices = static_cast<int>(factorial(n));
+    MetisPartition result;
+
+    // Rank 0 sorts the vertices by part (ascending within each part) and scatters them
+    std::vector<int> counts, displs, order;
+    if (rank == 0) {
+        if (nparts > 1 && num_vertices > 2) {
+            const std::uint64_t key = metis_options_key();
+            const std::string path = cache_dir.empty() ? "" : partition_cache_path(cache_dir, n, nparts, key);
+            if (!path.empty()) {
+                result.cached = PartitionCacheReader::open(path, n, nparts, key);
+            }
+            if (result.cached) {
+                LOG_INFO("Rank 0: Using cached partition " + path);
+            } else {
+                BubbleSortGraph graph(n);
+                result.computed = partition_graph(graph, nparts);
+                if (!path.empty()) {
+                    std::error_code ec;
+                    std::filesystem::create_directories(cache_dir, ec);
+                    write_partition_cache(path, n, nparts, key, result.computed);
+                }
+            }
+        } else {
+            result.computed.assign(num_vertices, 0);
+        }
+
+        const idx_t* parts = result.parts();
+        result.quality = measure_partition(n, nparts, parts);
+        LOG_INFO("Rank 0: METIS partition quality: " + result.quality.describe());
+        counts.assign(nparts, 0);
+        for (int v = 0; v < num_vertices; ++v) {
+            ++counts[parts[v]];
+        }
+        displs.assign(nparts, 0);
+        for (int r = 1; r < nparts; ++r) {
+            displs[r] = displs[r - 1] + counts[r - 1];
+        }
+        order.resize(num_vertices);
+        std::vector<int> next = displs;
+        for (int v = 0; v < num_vertices; ++v) {
+            order[next[parts[v]]++] = v;
+        }
+    }
+
+    int local_count = 0;
+    MPI_Scatter(counts.data(), 1, MPI_INT, &local_count, 1, MPI_INT, 0, MPI_COMM_WORLD);
+    result.local_vertices.resize(local_count);
+    MPI_Scatterv(order.data(), counts.data(), displs.data(), MPI_INT, result.local_vertices.data(), local_count, MPI_INT,
+                 0, MPI_COMM_WORLD);
+    prof_count(ProfCounter::BytesCommunicated, static_cast<std::int64_t>(local_count) * sizeof(int));
+    LOG_INFO("Rank " + std::to_string(rank) + ": Received " + std::to_string(local_count) + " local vertices.");
+    return result;
+}
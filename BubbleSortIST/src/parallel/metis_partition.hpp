@@ -2,9 +2,35 @@
 #define METIS_PARTITION_HPP
 
 #include "../graph/bubble_sort_graph.hpp"
+#include "../graph/partition_quality.hpp"
+#include "../io/partition_cache.hpp"
+#include <memory>
+#include <string>
 #include <vector>
 #include <metis.h>
 
+// Largest part over the mean part size METIS may produce; PrefixPartition
+// is held to the same bound so the two compare fairly.
+constexpr real_t kImbalanceTolerance = 1.05;
+
+// Runs METIS on the calling rank alone.
 std::vector<idx_t> partition_graph(const BubbleSortGraph& graph, int nparts);
 
-#endif
\ No newline at end of file
+// One rank's share of a METIS partition of B_n computed by rank 0.
+struct MetisPartition {
+    std::vector<int> local_vertices; // This rank's vertices, ascending
+    // Rank 0 only: the full partition, mapped from the cache or computed
+    std::unique_ptr<PartitionCacheReader> cached;
+    std::vector<idx_t> computed;
+    PartitionQuality quality; // Rank 0 only, measured on the full partition
+
+    const idx_t* parts() const { return cached ? cached->parts() : computed.data(); }
+};
+
+// Collective. Rank 0 maps the partition from cache_dir (see partition_cache.hpp)
+// or builds the graph and runs partition_graph, caching the result unless
+// cache_dir is empty, measures its quality, then scatters each rank its
+// vertex list.
+MetisPartition partition_vertices(int n, int nparts, const std::string& cache_dir);
+
+#endif
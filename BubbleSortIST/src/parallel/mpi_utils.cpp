@@ -1,91 +1,323 @@
 #include "mpi_utils.hpp"
+#include "../io/ist_file.hpp"
+#include "../utils/instrumentation.hpp"
 #include "../utils/logging.hpp"
+#include <filesystem>
 #include <fstream>
 #include <sstream>
 #include <stdexcept>
+#include <algorithm>
+#include <climits>
 
-std::vector<int> get_local_vertices(const std::vector<idx_t>& partition, int rank, int size, int num_vertices) {
-    std::vector<int> local_vertices;
-    for (int i = 0; i < num_vertices; ++i) {
-        if (partition[i] == rank) {
-            local_vertices.push_back(i);
+namespace {
+
+// Stages byte blocks at absolute file offsets and writes them with one
+// collective call through an hindexed file view. Blocks must be added in
+// ascending offset order; adjacent blocks coalesce.
+class CollectiveBlockWriter {
+public:
+    void add(MPI_Offset offset, const char* data, size_t length) {
+        if (!displacements_.empty() && displacements_.back() + block_lengths_.back() == offset &&
+            block_lengths_.back() + length <= static_cast<size_t>(INT_MAX)) {
+            block_lengths_.back() += static_cast<int>(length);
+        } else {
+            displacements_.push_back(offset);
+            block_lengths_.push_back(static_cast<int>(length));
+        }
+        buffer_.insert(buffer_.end(), data, data + length);
+    }
+
+    // Collective: every rank of the file's communicator must call it. Returns
+    // false if this rank's blocks were not all written.
+    bool flush(MPI_File fh) {
+        MPI_Datatype filetype = MPI_BYTE;
+        if (!displacements_.empty()) {
+            MPI_Type_create_hindexed(static_cast<int>(displacements_.size()), block_lengths_.data(), displacements_.data(),
+                                     MPI_BYTE, &filetype);
+            MPI_Type_commit(&filetype);
+        }
+        bool ok = MPI_File_set_view(fh, 0, MPI_BYTE, filetype, "native", MPI_INFO_NULL) == MPI_SUCCESS;
+        // Without the view the offsets are wrong, but the rank must still join the write
+        const int length = ok ? static_cast<int>(buffer_.size()) : 0;
+        MPI_Status status;
+        int written = 0;
+        if (MPI_File_write_all(fh, buffer_.data(), length, MPI_BYTE, &status) != MPI_SUCCESS ||
+            MPI_Get_count(&status, MPI_BYTE, &written) != MPI_SUCCESS || written != length) {
+            ok = false;
+        }
+        prof_count(ProfCounter::BytesWritten, written);
+        if (filetype != MPI_BYTE) {
+            MPI_Type_free(&filetype);
+        }
+        buffer_.clear();
+        block_lengths_.clear();
+        displacements_.clear();
+        return ok;
+    }
+
+private:
+    std::vector<char> buffer_;
+    std::vector<int> block_lengths_;
+    std::vector<MPI_Aint> displacements_;
+};
+
+bool all_ranks_ok(bool ok) {
+    int local = ok ? 1 : 0;
+    int all;
+    MPI_Allreduce(&local, &all, 1, MPI_INT, MPI_LAND, MPI_COMM_WORLD);
+    return all != 0;
+}
+
+MPI_File open_output_file(const std::string& filename, MPI_Offset file_size) {
+    MPI_File fh;
+    int err = MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    if (err != MPI_SUCCESS) {
+        LOG_ERROR("Failed to open output file: " + filename);
+        throw std::runtime_error("Cannot open output file: " + filename);
+    }
+    // Truncates stale content from a previous, larger run
+    if (!all_ranks_ok(MPI_File_set_size(fh, file_size) == MPI_SUCCESS)) {
+        MPI_File_close(&fh);
+        LOG_ERROR("Failed to size output file: " + filename);
+        throw std::runtime_error("Cannot size output file: " + filename);
+    }
+    return fh;
+}
+
+// Collective. Closes fh and throws on every rank if any rank failed a write
+// (ok == false) or the close, so no rank reports a damaged file as written.
+void close_output_file(MPI_File& fh, bool ok, const std::string& filename) {
+    ok = MPI_File_close(&fh) == MPI_SUCCESS && ok;
+    if (!all_ranks_ok(ok)) {
+        if (!ok) {
+            LOG_ERROR("Failed to write output file: " + filename);
         }
+        throw std::runtime_error("Cannot write output file: " + filename);
     }
-    return local_vertices;
 }
 
-std::vector<std::vector<int>> gather_parents(const std::vector<std::vector<int>>& local_parents,
-                                            const std::vector<int>& local_vertices,
-                                            const std::vector<idx_t>& partition,
-                                            int size, int num_vertices, int n) {
+// Every rank must join each collective write, so agree on the round count
+unsigned long long agree_on_rounds(size_t local_items, size_t items_per_round) {
+    unsigned long long local_rounds = (local_items + items_per_round - 1) / items_per_round;
+    unsigned long long rounds;
+    MPI_Allreduce(&local_rounds, &rounds, 1, MPI_UNSIGNED_LONG_LONG, MPI_MAX, MPI_COMM_WORLD);
+    return std::max(rounds, 1ULL);
+}
+
+// Vertices per collective write; bounds the per-rank staging buffer.
+constexpr size_t kVerticesPerRound = 1 << 20;
+
+} // namespace
+
+std::pair<Rank, Rank> local_rank_range(Rank total, int rank, int size) {
+    Rank base = total / size;
+    Rank extra = total % size;
+    Rank begin = rank * base + std::min<Rank>(rank, extra);
+    Rank end = begin + base + (rank < extra ? 1 : 0);
+    return {begin, end};
+}
+
+ResumePlan plan_checkpointed_run(const std::string& checkpoint_dir, const std::string& output_dir, int n, bool resume) {
+    ScopedTimer timer("plan_checkpointed_run");
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    log_info("Rank " + std::to_string(rank) + ": Entering gather_parents, local_parents size = " + std::to_string(local_parents.size()));
+    const Rank num_vertices = factorial(n);
+    ResumePlan plan;
+    std::vector<std::int64_t> bounds; // Flattened missing ranges
+    if (rank == 0) {
+        std::filesystem::create_directories(checkpoint_dir);
+        CheckpointScan scan;
+        if (resume) {
+            scan = scan_checkpoints(checkpoint_dir, ist_binary_path(output_dir, n), n);
+        } else {
+            remove_checkpoints(checkpoint_dir, n);
+        }
+        plan.generation = scan.next_generation;
+        plan.completed = range_count(scan.completed);
+        for (const RankRange& range : uncovered_ranges(scan.completed, num_vertices)) {
+            bounds.push_back(range.first);
+            bounds.push_back(range.second);
+        }
+        if (resume) {
+            LOG_INFO("Resuming B_" + std::to_string(n) + ": " + std::to_string(plan.completed) + " of " +
+                     std::to_string(num_vertices) + " vertices already written, " + std::to_string(bounds.size() / 2) +
+                     " ranges left.");
+        }
+    }
+    int header[2] = {plan.generation, static_cast<int>(bounds.size())};
+    MPI_Bcast(header, 2, MPI_INT, 0, MPI_COMM_WORLD);
+    plan.generation = header[0];
+    bounds.resize(header[1]);
+    MPI_Bcast(bounds.data(), header[1], MPI_INT64_T, 0, MPI_COMM_WORLD);
+    for (size_t i = 0; i < bounds.size(); i += 2) {
+        plan.missing.emplace_back(bounds[i], bounds[i + 1]);
+    }
+    plan.completed = num_vertices - range_count(plan.missing);
+    return plan;
+}
+
+ParentTable gather_parents(const ParentTable& local_parents, const idx_t* partition, int size, int num_vertices, int n) {
+    ScopedTimer timer("gather_parents");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Entering gather_parents, local_parents size = " + std::to_string(local_parents.size()));
 
-    std::vector<std::vector<int>> all_parents(num_vertices, std::vector<int>(n - 1, -1));
+    ParentTable all_parents;
     std::vector<int> counts(size), displs(size);
     int local_size = local_parents.size() * (n - 1);
 
     // Gather counts
-    log_info("Rank " + std::to_string(rank) + ": Gathering counts, local_size = " + std::to_string(local_size));
+    LOG_INFO("Rank " + std::to_string(rank) + ": Gathering counts, local_size = " + std::to_string(local_size));
     MPI_Gather(&local_size, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
     if (rank == 0) {
         displs[0] = 0;
         for (int i = 1; i < size; ++i) {
             displs[i] = displs[i - 1] + counts[i - 1];
         }
-        log_info("Rank 0: Computed displacements, displs = [" + [&displs]() {
+        LOG_DEBUG("Rank 0: Computed displacements, displs = [" + [&displs]() {
             std::stringstream ss;
             for (int d : displs) ss << d << " ";
             return ss.str();
         }() + "]");
     }
 
-    // Gather parents
-    std::vector<int> flat_local_parents;
-    for (const auto& p : local_parents) {
-        flat_local_parents.insert(flat_local_parents.end(), p.begin(), p.end());
-    }
-    std::vector<int> flat_all_parents(num_vertices * (n - 1));
-    log_info("Rank " + std::to_string(rank) + ": Calling MPI_Gatherv, flat_local_parents size = " + std::to_string(flat_local_parents.size()));
-    MPI_Gatherv(flat_local_parents.data(), local_size, MPI_INT, flat_all_parents.data(),
+    // Gather parents; the local table is already flat
+    std::vector<int> flat_all_parents(rank == 0 ? static_cast<size_t>(num_vertices) * (n - 1) : 0);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Calling MPI_Gatherv, local_size = " + std::to_string(local_size));
+    prof_count(ProfCounter::BytesCommunicated, static_cast<std::int64_t>(local_size) * sizeof(int));
+    MPI_Gatherv(local_parents.data(), local_size, MPI_INT, flat_all_parents.data(),
                 counts.data(), displs.data(), MPI_INT, 0, MPI_COMM_WORLD);
-    log_info("Rank " + std::to_string(rank) + ": MPI_Gatherv completed.");
+    LOG_INFO("Rank " + std::to_string(rank) + ": MPI_Gatherv completed.");
 
-    // Reconstruct all_parents
+    // Reconstruct all_parents in one pass: every rank's vertices are ascending,
+    // so vertex v is the next row of its part's block
     if (rank == 0) {
-        for (int r = 0; r < size; ++r) {
-            std::vector<int> local_verts = get_local_vertices(partition, r, size, num_vertices);
-            for (size_t i = 0; i < local_verts.size(); ++i) {
-                int v_idx = local_verts[i];
-                for (int t = 0; t < n - 1; ++t) {
-                    all_parents[v_idx][t] = flat_all_parents[displs[r] + i * (n - 1) + t];
-                }
-            }
+        all_parents = ParentTable(num_vertices, n);
+        std::vector<int> next = displs;
+        for (int v = 0; v < num_vertices; ++v) {
+            const idx_t r = partition[v];
+            std::copy_n(&flat_all_parents[next[r]], n - 1, all_parents.row(v));
+            next[r] += n - 1;
         }
-        log_info("Rank 0: Reconstructed all_parents.");
+        LOG_INFO("Rank 0: Reconstructed all_parents.");
     }
     return all_parents;
 }
 
-void output_ists(const BubbleSortGraph& graph, const std::vector<std::vector<int>>& parents, int n,
-                 const std::string& output_dir) {
-    std::string filename = output_dir + "ists_B" + std::to_string(n) + ".txt";
+ParentTable gather_parents_range(const ParentTable& local_parents, int size, int num_vertices, int n) {
+    ScopedTimer timer("gather_parents");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Entering gather_parents_range, local_parents size = " + std::to_string(local_parents.size()));
+
+    // Ranges are contiguous and ordered by rank, so the parents are received
+    // straight into the table in vertex order.
+    const int local_size = static_cast<int>(local_parents.size() * (n - 1));
+    std::vector<int> counts(size), displs(size);
+    MPI_Gather(&local_size, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    for (int r = 1; r < size; ++r) {
+        displs[r] = displs[r - 1] + counts[r - 1];
+    }
+
+    ParentTable all_parents = rank == 0 ? ParentTable(num_vertices, n) : ParentTable();
+    prof_count(ProfCounter::BytesCommunicated, static_cast<std::int64_t>(local_size) * sizeof(int));
+    MPI_Gatherv(local_parents.data(), local_size, MPI_INT, all_parents.data(),
+                counts.data(), displs.data(), MPI_INT, 0, MPI_COMM_WORLD);
+    LOG_INFO("Rank " + std::to_string(rank) + ": MPI_Gatherv completed.");
+    return all_parents;
+}
+
+void output_ists(const ParentTable& parents, int n, const std::string& output_dir) {
+    ScopedTimer timer("output_ists");
+    std::string filename = ist_text_path(output_dir, n);
     std::ofstream out(filename);
     if (!out.is_open()) {
-        log_error("Failed to open output file: " + filename);
+        LOG_ERROR("Failed to open output file: " + filename);
         throw std::runtime_error("Cannot open output file: " + filename);
     }
+    IstTextLayout layout(n);
+    std::string line = layout.blank_line();
     for (int t = 1; t <= n - 1; ++t) {
-        out << "Tree T_" << t << "^" << n << ":\n";
+        out << layout.header(t);
         for (size_t i = 0; i < parents.size(); ++i) {
-            if (parents[i][t - 1] != -1) {
-                out << "Vertex " << graph.vertices()[i].to_string() << " -> Parent "
-                    << graph.vertices()[parents[i][t - 1]].to_string() << "\n";
+            if (parents.parent(i, t) != -1) {
+                layout.format_line(&line[0], i, parents.parent(i, t));
+                out.write(line.data(), line.size());
             }
         }
         out << "\n";
     }
+    prof_count(ProfCounter::BytesWritten, out.tellp());
     out.close();
-    log_info("Output written to " + filename);
-}
\ No newline at end of file
+    LOG_INFO("Output written to " + filename);
+}
+
+void output_ists_mpiio(const std::vector<int>& local_vertices, const ParentTable& local_parents, int n, const std::string& output_dir) {
+    ScopedTimer timer("output_ists_mpiio");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    std::string filename = ist_text_path(output_dir, n);
+    IstTextLayout layout(n);
+    MPI_File fh = open_output_file(filename, layout.file_size());
+
+    unsigned long long rounds = agree_on_rounds(local_vertices.size(), kVerticesPerRound);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Writing " + std::to_string(local_vertices.size()) + " vertices per tree in " +
+             std::to_string(rounds) + " collective rounds.");
+
+    std::string line = layout.blank_line();
+    CollectiveBlockWriter writer;
+    bool ok = true;
+    for (int t = 1; t <= n - 1; ++t) {
+        for (unsigned long long round = 0; round < rounds; ++round) {
+            if (rank == 0 && round == 0) {
+                std::string header = layout.header(t);
+                writer.add(layout.tree_offset(t), header.data(), header.size());
+            }
+            size_t first = std::min(local_vertices.size(), static_cast<size_t>(round) * kVerticesPerRound);
+            size_t last = std::min(local_vertices.size(), first + kVerticesPerRound);
+            for (size_t i = first; i < last; ++i) {
+                int parent = local_parents.parent(i, t);
+                if (parent != -1) {
+                    layout.format_line(&line[0], local_vertices[i], parent);
+                    writer.add(layout.line_offset(t, local_vertices[i]), line.data(), line.size());
+                }
+            }
+            if (rank == 0 && round == rounds - 1) {
+                writer.add(layout.tree_offset(t + 1) - 1, "\n", 1);
+            }
+            ok = writer.flush(fh) && ok;
+        }
+    }
+    close_output_file(fh, ok, filename);
+    LOG_INFO("Rank " + std::to_string(rank) + ": MPI-IO output written to " + filename);
+}
+
+void output_ists_binary(const std::vector<int>& local_vertices, const ParentTable& local_parents, int n, const std::string& output_dir) {
+    ScopedTimer timer("output_ists_binary");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    std::string filename = ist_binary_path(output_dir, n);
+    IstFileHeader header = make_ist_header(n);
+    size_t record_size = header.record_size;
+    MPI_File fh = open_output_file(filename, sizeof(IstFileHeader) + header.num_vertices * record_size);
+
+    unsigned long long rounds = agree_on_rounds(local_vertices.size(), kVerticesPerRound);
+    std::vector<char> record(record_size);
+    CollectiveBlockWriter writer;
+    bool ok = true;
+    for (unsigned long long round = 0; round < rounds; ++round) {
+        if (rank == 0 && round == 0) {
+            writer.add(0, reinterpret_cast<const char*>(&header), sizeof(header));
+        }
+        size_t first = std::min(local_vertices.size(), static_cast<size_t>(round) * kVerticesPerRound);
+        size_t last = std::min(local_vertices.size(), first + kVerticesPerRound);
+        for (size_t i = first; i < last; ++i) {
+            encode_ist_record(local_vertices[i], local_parents.row(i), n, reinterpret_cast<unsigned char*>(record.data()));
+            writer.add(sizeof(IstFileHeader) + static_cast<MPI_Offset>(local_vertices[i]) * record_size, record.data(),
+                       record_size);
+        }
+        ok = writer.flush(fh) && ok;
+    }
+    close_output_file(fh, ok, filename);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Binary IST file written to " + filename);
+}
@@ -2,16 +2,39 @@
 #define MPI_UTILS_HPP
 
 #include "../graph/bubble_sort_graph.hpp"
+#include "../io/checkpoint.hpp"
+#include "../utils/parent_table.hpp"
 #include <vector>
+#include <utility>
+#include <string>
 #include <mpi.h>
 #include <metis.h>
 
-std::vector<int> get_local_vertices(const std::vector<idx_t>& partition, int rank, int size, int num_vertices);
-std::vector<std::vector<int>> gather_parents(const std::vector<std::vector<int>>& local_parents,
-                                            const std::vector<int>& local_vertices,
-                                            const std::vector<idx_t>& partition,
-                                            int size, int num_vertices, int n);
-void output_ists(const BubbleSortGraph& graph, const std::vector<std::vector<int>>& parents, int n,
-                 const std::string& output_dir);
+// Contiguous share [first, second) of the vertex ranks 0..total-1 owned by rank.
+std::pair<Rank, Rank> local_rank_range(Rank total, int rank, int size);
+// Work of a checkpointed streaming run (see stream_ists_binary).
+struct ResumePlan {
+    std::vector<RankRange> missing; // Vertex ranks still to compute, to be split across ranks
+    Rank completed = 0;             // Vertices already in the .ist file
+    int generation = 0;             // For this run's journals
+};
+// Collective. When resuming, rank 0 merges the journals of all earlier runs,
+// whatever their rank count; otherwise it removes them and nothing counts as
+// completed. The plan is broadcast to all ranks.
+ResumePlan plan_checkpointed_run(const std::string& checkpoint_dir, const std::string& output_dir, int n, bool resume);
+// Both gathers return the full table (vertex order) on rank 0, empty elsewhere.
+// gather_parents needs the full partition on rank 0 only (see MetisPartition::parts).
+ParentTable gather_parents(const ParentTable& local_parents, const idx_t* partition, int size, int num_vertices, int n);
+// Gathers parents of contiguous rank ranges, ascending with the MPI rank (see
+// local_rank_range and PrefixPartition), to rank 0.
+ParentTable gather_parents_range(const ParentTable& local_parents, int size, int num_vertices, int n);
+void output_ists(const ParentTable& parents, int n, const std::string& output_dir);
+// Collective MPI-IO variant of output_ists: each rank writes the lines of its
+// own vertices (ascending ranks) at computed offsets of the same file, so no
+// rank ever holds the full parent table.
+void output_ists_mpiio(const std::vector<int>& local_vertices, const ParentTable& local_parents, int n, const std::string& output_dir);
+// Collective write of the binary .ist file (see io/ist_file.hpp); same
+// requirements on local_vertices as output_ists_mpiio.
+void output_ists_binary(const std::vector<int>& local_vertices, const ParentTable& local_parents, int n, const std::string& output_dir);
 
 #endif
\ No newline at end of file
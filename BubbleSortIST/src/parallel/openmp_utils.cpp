@@ -1,29 +1,214 @@
 #include "openmp_utils.hpp"
+#include "../algorithm/ist_batch.hpp"
 #include "../algorithm/ist_construct.hpp"
+#include "../utils/instrumentation.hpp"
 #include "../utils/logging.hpp"
+#include <algorithm>
 #include <mpi.h>
 #include <omp.h>
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
 
-std::vector<std::vector<int>> construct_ists_parallel(const BubbleSortGraph& graph,
-                                                     const std::vector<int>& vertices, int n) {
+namespace {
+
+LoopSchedule g_schedule = LoopSchedule::Static;
+int g_chunk = 0;
+ThreadBinding g_binding = ThreadBinding::None;
+int g_rank = 0; // For messages: pinning also runs on helper threads, which must not call MPI
+
+// OMP_PLACES, or one place per CPU of the process affinity mask. Taken once,
+// before any pinning narrows the mask of the calling thread.
+const std::vector<std::vector<int>>& binding_places() {
+    static const std::vector<std::vector<int>> places = [] {
+        std::vector<std::vector<int>> result;
+        for (int p = 0; p < omp_get_num_places(); ++p) {
+            std::vector<int> ids(omp_get_place_num_procs(p));
+            omp_get_place_proc_ids(p, ids.data());
+            result.push_back(ids);
+        }
+#ifdef __linux__
+        if (result.empty()) {
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+                for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                    if (CPU_ISSET(cpu, &set)) {
+                        result.push_back({cpu});
+                    }
+                }
+            }
+        }
+#endif
+        return result;
+    }();
+    return places;
+}
+
+} // namespace
+
+void set_loop_schedule(LoopSchedule schedule, int chunk) {
+    g_schedule = schedule;
+    g_chunk = chunk;
+}
+
+void apply_loop_schedule() {
+    // The loops below hand out batches, not vertices
+    const int chunk = (g_chunk + kIstBatchSize - 1) / kIstBatchSize;
+    switch (g_schedule) {
+    case LoopSchedule::Static:
+        omp_set_schedule(omp_sched_static, chunk);
+        break;
+    case LoopSchedule::Dynamic:
+        omp_set_schedule(static_cast<omp_sched_t>(omp_sched_dynamic | omp_sched_monotonic), chunk);
+        break;
+    case LoopSchedule::Guided:
+        omp_set_schedule(omp_sched_guided, chunk);
+        break;
+    case LoopSchedule::Steal:
+        // Nonmonotonic dynamic: threads may take chunks out of order, which
+        // lets the runtime steal from other threads' queues
+        omp_set_schedule(omp_sched_dynamic, chunk);
+        break;
+    }
+}
+
+void set_thread_binding(ThreadBinding binding) {
+    g_binding = binding;
+    MPI_Comm_rank(MPI_COMM_WORLD, &g_rank);
+}
+
+void pin_omp_threads() {
+    if (g_binding == ThreadBinding::None) {
+        return;
+    }
+    const int rank = g_rank;
+    if (omp_get_proc_bind() != omp_proc_bind_false) {
+        LOG_INFO("Rank " + std::to_string(rank) + ": OMP_PROC_BIND is set, leaving thread binding to the OpenMP runtime.");
+        return;
+    }
+#ifdef __linux__
+    const std::vector<std::vector<int>>& places = binding_places();
+    if (places.empty()) {
+        LOG_ERROR("Rank " + std::to_string(rank) + ": No places to bind OpenMP threads to.");
+        return;
+    }
+    const int num_places = static_cast<int>(places.size());
+    int threads = 0;
+    #pragma omp parallel
+    {
+        const int thread = omp_get_thread_num();
+        const int team = omp_get_num_threads();
+        const int place = g_binding == ThreadBinding::Close ? thread % num_places
+                                                            : static_cast<int>(static_cast<long long>(thread) * num_places / team);
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        for (int cpu : places[place]) {
+            CPU_SET(cpu, &set);
+        }
+        pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+        #pragma omp single
+        threads = team;
+    }
+    LOG_INFO("Rank " + std::to_string(rank) + ": Bound " + std::to_string(threads) + " OpenMP threads to " +
+             std::to_string(num_places) + " places (" + to_string(g_binding) + ").");
+#else
+    LOG_INFO("Rank " + std::to_string(rank) + ": Thread binding is only implemented on Linux.");
+#endif
+}
+
+void ParallelErrors::rethrow_if_failed() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (error_) {
+        std::rethrow_exception(error_);
+    }
+}
+
+void ParallelErrors::capture(std::exception_ptr error) noexcept {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!error_) {
+        error_ = error;
+    }
+    failed_.store(true, std::memory_order_relaxed);
+}
+
+ParentTable construct_ists_parallel(const BubbleSortGraph& graph, const std::vector<int>& vertices, int n) {
+    ScopedTimer timer("construct_ists_parallel");
     int rank;
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    log_info("Rank " + std::to_string(rank) + ": Starting parallel IST construction for " + std::to_string(vertices.size()) + " vertices.");
+    LOG_INFO("Rank " + std::to_string(rank) + ": Starting parallel IST construction for " + std::to_string(vertices.size()) + " vertices.");
 
-    std::vector<std::vector<int>> parents(vertices.size(), std::vector<int>(n - 1));
+    // Checked once up front, keeping the batch loop free of per-vertex branches
+    const auto bad_vertex = std::find_if(vertices.begin(), vertices.end(),
+                                         [&](int v) { return v < 0 || v >= graph.num_vertices(); });
+    if (bad_vertex != vertices.end()) {
+        LOG_ERROR("Rank " + std::to_string(rank) + ": Invalid vertex index " + std::to_string(*bad_vertex));
+        throw std::runtime_error("Invalid vertex index");
+    }
 
-    #pragma omp parallel for
-    for (size_t i = 0; i < vertices.size(); ++i) {
-        int thread_id = omp_get_thread_num();
-        if (vertices[i] < 0 || vertices[i] >= graph.num_vertices()) {
-            log_error("Rank " + std::to_string(rank) + ": Invalid vertex index " + std::to_string(vertices[i]));
-            throw std::runtime_error("Invalid vertex index");
+    ParentTable parents(vertices.size(), n);
+    const std::int64_t count = static_cast<std::int64_t>(vertices.size());
+    const std::int64_t num_batches = (count + kIstBatchSize - 1) / kIstBatchSize;
+    ParallelErrors errors;
+    apply_loop_schedule();
+    #pragma omp parallel
+    {
+        ScopedTimer thread_timer("construct_ists_parallel_thread");
+        std::int64_t processed = 0;
+        #pragma omp for schedule(runtime)
+        for (std::int64_t b = 0; b < num_batches; ++b) {
+            errors.run([&] {
+                const std::int64_t first = b * kIstBatchSize;
+                const int batch = static_cast<int>(std::min<std::int64_t>(kIstBatchSize, count - first));
+                Rank ranks[kIstBatchSize] = {};
+                for (int i = 0; i < batch; ++i) {
+                    ranks[i] = vertices[first + i];
+                }
+                // All n-1 parents come from the vertex rank alone, a SIMD batch at a time
+                parent_ranks_batch(ranks, batch, n, parents.row(first));
+                processed += batch;
+            });
         }
-        log_info("Rank " + std::to_string(rank) + ", Thread " + std::to_string(thread_id) + ": Processing vertex " + std::to_string(vertices[i]));
-        for (int t = 1; t <= n - 1; ++t) {
-            parents[i][t - 1] = parent1(graph, vertices[i], t, n);
+        prof_count(ProfCounter::VerticesProcessed, processed);
+    }
+    errors.rethrow_if_failed();
+    LOG_INFO("Rank " + std::to_string(rank) + ": Parallel IST construction completed.");
+    return parents;
+}
+
+ParentTable construct_ists_range(Rank begin, Rank end, int n) {
+    ScopedTimer timer("construct_ists_range");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    LOG_INFO("Rank " + std::to_string(rank) + ": Starting parallel IST construction for ranks [" + std::to_string(begin) +
+             ", " + std::to_string(end) + ").");
+
+    ParentTable parents(end - begin, n);
+    const Rank count = end - begin;
+    const Rank num_batches = (count + kIstBatchSize - 1) / kIstBatchSize;
+    ParallelErrors errors;
+    apply_loop_schedule();
+    #pragma omp parallel
+    {
+        ScopedTimer thread_timer("construct_ists_range_thread");
+        std::int64_t processed = 0;
+        #pragma omp for schedule(runtime)
+        for (Rank b = 0; b < num_batches; ++b) {
+            errors.run([&] {
+                const Rank first = b * kIstBatchSize;
+                const int batch = static_cast<int>(std::min<Rank>(kIstBatchSize, count - first));
+                Rank ranks[kIstBatchSize] = {};
+                for (int i = 0; i < batch; ++i) {
+                    ranks[i] = begin + first + i;
+                }
+                parent_ranks_batch(ranks, batch, n, parents.row(first));
+                processed += batch;
+            });
         }
+        prof_count(ProfCounter::VerticesProcessed, processed);
     }
-    log_info("Rank " + std::to_string(rank) + ": Parallel IST construction completed.");
+    errors.rethrow_if_failed();
+    LOG_INFO("Rank " + std::to_string(rank) + ": Parallel IST construction completed.");
     return parents;
-}
\ No newline at end of file
+}
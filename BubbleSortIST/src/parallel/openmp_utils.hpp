@@ -2,9 +2,56 @@
 #define OPENMP_UTILS_HPP
 
 #include "../graph/bubble_sort_graph.hpp"
+#include "../utils/config.hpp"
+#include "../utils/parent_table.hpp"
+#include <atomic>
+#include <exception>
+#include <mutex>
 #include <vector>
 
-std::vector<std::vector<int>> construct_ists_parallel(const BubbleSortGraph& graph,
-                                                     const std::vector<int>& vertices, int n);
+ParentTable construct_ists_parallel(const BubbleSortGraph& graph, const std::vector<int>& vertices, int n);
+// Parents of the vertices with ranks [begin, end), computed without any graph.
+ParentTable construct_ists_range(Rank begin, Rank end, int n);
 
-#endif
\ No newline at end of file
+// Schedule of the construction loops; chunk is in vertices (0: runtime default).
+void set_loop_schedule(LoopSchedule schedule, int chunk);
+// Installs that schedule for schedule(runtime) loops started by the calling
+// thread. The setting is per thread, so helper threads call it too.
+void apply_loop_schedule();
+
+void set_thread_binding(ThreadBinding binding);
+// Pins the OpenMP team of the calling thread, one place per thread: the
+// places of OMP_PLACES if set, else the CPUs this process may run on (its MPI
+// binding). Does nothing for ThreadBinding::None or when OMP_PROC_BIND already
+// makes the runtime bind.
+void pin_omp_threads();
+
+// Carries the first exception out of an OpenMP region, which an exception
+// must never leave (std::terminate). Loop bodies run through run(); once a
+// thread has failed, the remaining iterations are skipped. Call
+// rethrow_if_failed() after the region.
+class ParallelErrors {
+public:
+    template <typename F>
+    void run(F&& body) noexcept {
+        if (failed()) {
+            return;
+        }
+        try {
+            body();
+        } catch (...) {
+            capture(std::current_exception());
+        }
+    }
+    bool failed() const { return failed_.load(std::memory_order_relaxed); }
+    void rethrow_if_failed();
+
+private:
+    void capture(std::exception_ptr error) noexcept;
+
+    std::atomic<bool> failed_{false};
+    std::mutex mutex_;
+    std::exception_ptr error_;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#include "prefix_partition.hpp"
+#include "../utils/logging.hpp"
+#include <stdexcept>
+#include <string>
+
+PrefixPartition::PrefixPartition(int n, int nparts, double imbalance_tolerance) : n_(n), nparts_(nparts) {
+    if (nparts < 1) {
+        LOG_ERROR("Invalid part count for prefix partition: " + std::to_string(nparts));
+        throw std::invalid_argument("nparts must be >= 1");
+    }
+    // B_n only has classes down to single vertices (L = n-1 and L = n
+    // coincide), so n-1 is admissible even when it cannot meet the tolerance
+    int best_length = -1;
+    std::int64_t best_cut = 0;
+    for (int length = 0; length <= n - 1; ++length) {
+        set_prefix_length(length);
+        if (length < n - 1 && !balanced(imbalance_tolerance)) {
+            continue;
+        }
+        if (num_classes_ > kMaxEvaluatedClasses) {
+            if (best_length < 0) {
+                best_length = length; // The only candidate left is too large to evaluate
+            }
+            break;
+        }
+        const std::int64_t cut = quality().edge_cut;
+        if (best_length < 0 || cut < best_cut) {
+            best_length = length;
+            best_cut = cut;
+        }
+        if (best_cut == 0) {
+            break;
+        }
+    }
+    set_prefix_length(best_length);
+}
+
+void PrefixPartition::set_prefix_length(int length) {
+    length_ = length;
+    class_size_ = factorial(n_ - length);
+    num_classes_ = factorial(n_) / class_size_;
+    base_ = num_classes_ / nparts_;
+    extra_ = num_classes_ % nparts_;
+}
+
+bool PrefixPartition::balanced(double imbalance_tolerance) const {
+    if (base_ == 0) {
+        return false; // Fewer classes than parts
+    }
+    const Rank largest = (base_ + (extra_ > 0 ? 1 : 0)) * class_size_;
+    return static_cast<double>(largest) * nparts_ <= imbalance_tolerance * num_classes_ * class_size_;
+}
+
+int PrefixPartition::part_of_class(Rank c) const {
+    // Inverse of first_class: the first extra_ parts hold base_ + 1 classes
+    const Rank wide = extra_ * (base_ + 1);
+    if (c < wide) {
+        return static_cast<int>(c / (base_ + 1));
+    }
+    return static_cast<int>(extra_ + (c - wide) / base_);
+}
+
+int PrefixPartition::part(Rank v) const {
+    return part_of_class(v / class_size_);
+}
+
+std::pair<Rank, Rank> PrefixPartition::range(int part) const {
+    return {first_class(part) * class_size_, first_class(part + 1) * class_size_};
+}
+
+PartitionQuality PrefixPartition::quality() const {
+    const Rank num_vertices = num_classes_ * class_size_;
+    PartitionQuality quality;
+    quality.num_edges = num_vertices * (n_ - 1) / 2;
+    quality.imbalance = static_cast<double>(base_ + (extra_ > 0 ? 1 : 0)) * class_size_ * nparts_ / num_vertices;
+    if (length_ == 0) {
+        return quality;
+    }
+
+    // Swap i < L maps a whole class onto one other class. Swap L moves the
+    // symbol at L+1 into the prefix: the j-th smallest suffix symbol sits
+    // there in a block of (n-L-1)! vertices starting at class start + j (n-L-1)!.
+    const Rank block = factorial(n_ - length_ - 1);
+    std::int64_t cut_ends = 0;
+    #pragma omp parallel for schedule(static) reduction(+ : cut_ends)
+    for (Rank c = 0; c < num_classes_; ++c) {
+        const Rank start = c * class_size_;
+        const int p = part_of_class(c);
+        for (int i = 1; i < length_; ++i) {
+            if (part(adjacent_rank(start, n_, i)) != p) {
+                cut_ends += class_size_;
+            }
+        }
+        for (int j = 0; j < n_ - length_; ++j) {
+            if (part(adjacent_rank(start + j * block, n_, length_)) != p) {
+                cut_ends += block;
+            }
+        }
+    }
+    quality.edge_cut = cut_ends / 2;
+    return quality;
+}
@@ -0,0 +1,54 @@
+#ifndef PREFIX_PARTITION_HPP
+#define PREFIX_PARTITION_HPP
+
+#include "../graph/partition_quality.hpp"
+#include "../utils/permutation.hpp"
+#include <algorithm>
+#include <utility>
+
+// Partition of B_n built from its Cayley-graph structure instead of METIS.
+// Vertices whose first L symbols agree form a prefix class; the classes are
+// dealt to the parts in contiguous blocks. Lexicographic order is Lehmer-rank
+// order, so each class, and each part, is a contiguous rank range: a vertex's
+// part is O(1) arithmetic on its rank and no graph is ever built.
+//
+// Only swaps (i, i+1) with i <= L leave a class, so the cut of every L is
+// known in closed form per class. Of the lengths whose classes can be dealt
+// within the imbalance tolerance, the constructor keeps the one with the
+// smallest cut, trying longer ones while they have at most
+// kMaxEvaluatedClasses classes. With L = n-1 every vertex is its own class
+// and the parts equal local_rank_range.
+class PrefixPartition {
+public:
+    static constexpr Rank kMaxEvaluatedClasses = 1 << 16;
+
+    PrefixPartition(int n, int nparts, double imbalance_tolerance);
+
+    int prefix_length() const { return length_; }
+    Rank class_size() const { return class_size_; }
+    Rank num_classes() const { return num_classes_; }
+
+    int part(Rank v) const;
+    // Vertex ranks [first, second) of a part; parts are ordered by rank.
+    std::pair<Rank, Rank> range(int part) const;
+
+    // Exact edge cut and balance, computed per class rather than per vertex:
+    // O(n) neighbor ranks for each of the num_classes() classes.
+    PartitionQuality quality() const;
+
+private:
+    void set_prefix_length(int length);
+    bool balanced(double imbalance_tolerance) const;
+    Rank first_class(int part) const { return part * base_ + std::min<Rank>(part, extra_); }
+    int part_of_class(Rank c) const;
+
+    int n_;
+    int nparts_;
+    int length_ = 0;
+    Rank class_size_ = 1;  // (n - L)!
+    Rank num_classes_ = 1; // n! / (n - L)!
+    Rank base_ = 0;        // Classes per part, plus one for the first extra_ parts
+    Rank extra_ = 0;
+};
+
+#endif
@@ -0,0 +1,193 @@
+#include "streaming.hpp"
+#include "openmp_utils.hpp"
+#include "../algorithm/ist_batch.hpp"
+#include "../io/ist_file.hpp"
+#include "../utils/bounded_queue.hpp"
+#include "../utils/instrumentation.hpp"
+#include "../utils/logging.hpp"
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include <mpi.h>
+#include <omp.h>
+
+namespace {
+
+struct RecordBlock {
+    Rank first = 0;     // Rank of the first vertex in the block
+    Rank count = 0;     // Vertices in the block
+    std::vector<unsigned char> records;
+};
+
+} // namespace
+
+void stream_ists_binary(const std::vector<RankRange>& ranges, int n, const std::string& output_dir,
+                        const StreamCheckpoint* checkpoint, size_t block_size, size_t queue_depth) {
+    ScopedTimer timer("stream_ists_binary");
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    const std::string filename = ist_binary_path(output_dir, n);
+    const IstFileHeader header = make_ist_header(n);
+    const size_t record_size = header.record_size;
+    LOG_INFO("Rank " + std::to_string(rank) + ": Streaming " + std::to_string(range_count(ranges)) + " ranks in " +
+             std::to_string(ranges.size()) + " ranges, in blocks of " + std::to_string(block_size) + " vertices.");
+
+    MPI_File fh;
+    int err = MPI_File_open(MPI_COMM_WORLD, filename.c_str(), MPI_MODE_CREATE | MPI_MODE_WRONLY, MPI_INFO_NULL, &fh);
+    if (err != MPI_SUCCESS) {
+        LOG_ERROR("Failed to open output file: " + filename);
+        throw std::runtime_error("Cannot open output file: " + filename);
+    }
+    err = MPI_File_set_size(fh, sizeof(IstFileHeader) + header.num_vertices * record_size);
+    if (err != MPI_SUCCESS) {
+        MPI_File_close(&fh);
+        LOG_ERROR("Failed to size output file: " + filename);
+        throw std::runtime_error("Cannot size output file: " + filename);
+    }
+    // A failed write ends the run after the collective close; nothing after
+    // it is journaled
+    bool write_failed = false;
+    if (rank == 0) {
+        err = MPI_File_write_at(fh, 0, &header, sizeof(header), MPI_BYTE, MPI_STATUS_IGNORE);
+        if (err != MPI_SUCCESS) {
+            LOG_ERROR("Failed to write header of " + filename);
+            write_failed = true;
+        }
+        prof_count(ProfCounter::BytesWritten, sizeof(header));
+    }
+    // Checkpoint errors only cost the ability to resume, so they stop the
+    // journal rather than the collective write
+    std::unique_ptr<CheckpointWriter> journal;
+    auto journal_call = [&](auto&& call) {
+        try {
+            call();
+        } catch (const std::exception& e) {
+            LOG_ERROR("Rank " + std::to_string(rank) + ": Checkpointing disabled: " + e.what());
+            journal.reset();
+        }
+    };
+    // Blocks go through out. With a checkpoint it is a handle of this rank
+    // alone, since the journal syncs it on its own schedule and MPI_File_sync
+    // is collective over the handle's communicator.
+    MPI_File out = fh;
+    if (checkpoint != nullptr) {
+        // After the collective open, so the data file exists
+        if (MPI_File_open(MPI_COMM_SELF, filename.c_str(), MPI_MODE_WRONLY, MPI_INFO_NULL, &out) != MPI_SUCCESS) {
+            LOG_ERROR("Rank " + std::to_string(rank) + ": Failed to reopen " + filename + "; checkpointing disabled.");
+            out = fh;
+        } else {
+            journal_call([&] {
+                journal.reset(new CheckpointWriter(checkpoint_path(checkpoint->dir, n, checkpoint->generation, rank), out,
+                                                   n, checkpoint->interval_seconds));
+            });
+        }
+    }
+
+    // Blocks circulate between the two queues, so their buffers are allocated once
+    BoundedQueue<RecordBlock> free_blocks(queue_depth + 1);
+    BoundedQueue<RecordBlock> full_blocks(queue_depth);
+    for (size_t i = 0; i < queue_depth + 1; ++i) {
+        RecordBlock block;
+        block.records.resize(block_size * record_size);
+        free_blocks.push(std::move(block));
+    }
+
+    // Blocks never straddle two ranges
+    std::vector<RankRange> spans;
+    for (const RankRange& range : ranges) {
+        for (Rank first = range.first; first < range.second; first += block_size) {
+            spans.emplace_back(first, std::min<Rank>(first + block_size, range.second));
+        }
+    }
+
+    std::exception_ptr producer_error;
+    std::thread producer([&] {
+        try {
+            // Schedule and binding are per thread; this one runs its own OpenMP team
+            apply_loop_schedule();
+            pin_omp_threads();
+            for (const RankRange& span : spans) {
+                RecordBlock block;
+                if (!free_blocks.pop(block)) {
+                    break;
+                }
+                ScopedTimer block_timer("stream_compute_block");
+                const Rank first = span.first;
+                block.first = first;
+                block.count = span.second - first;
+                unsigned char* records = block.records.data();
+                const Rank count = block.count;
+                const Rank num_batches = (count + kIstBatchSize - 1) / kIstBatchSize;
+                ParallelErrors errors;
+                #pragma omp parallel for schedule(runtime)
+                for (Rank b = 0; b < num_batches; ++b) {
+                    errors.run([&] {
+                        const Rank offset = b * kIstBatchSize;
+                        const int batch = static_cast<int>(std::min<Rank>(kIstBatchSize, count - offset));
+                        Rank ranks[kIstBatchSize] = {};
+                        int swaps[kIstBatchSize * (Permutation::kMaxSize - 1)];
+                        for (int i = 0; i < batch; ++i) {
+                            ranks[i] = first + offset + i;
+                        }
+                        parent_swap_positions_batch(ranks, batch, n, swaps);
+                        for (int i = 0; i < batch; ++i) {
+                            encode_ist_swaps(swaps + i * (n - 1), n, records + (offset + i) * record_size);
+                        }
+                    });
+                }
+                errors.rethrow_if_failed();
+                prof_count(ProfCounter::VerticesProcessed, block.count);
+                if (!full_blocks.push(std::move(block))) {
+                    break;
+                }
+            }
+        } catch (...) {
+            producer_error = std::current_exception();
+        }
+        full_blocks.close();
+    });
+
+    // Writer stage: independent writes, since ranks produce different block counts
+    RecordBlock block;
+    size_t blocks_written = 0;
+    while (!write_failed && full_blocks.pop(block)) {
+        ScopedTimer block_timer("stream_write_block");
+        MPI_Offset offset = sizeof(IstFileHeader) + static_cast<MPI_Offset>(block.first) * record_size;
+        err = MPI_File_write_at(out, offset, block.records.data(), static_cast<int>(block.count * record_size), MPI_BYTE,
+                                MPI_STATUS_IGNORE);
+        if (err != MPI_SUCCESS) {
+            LOG_ERROR("Rank " + std::to_string(rank) + ": Failed to write ranks " + std::to_string(block.first) + ".." +
+                      std::to_string(block.first + block.count - 1) + " to " + filename);
+            write_failed = true;
+            break;
+        }
+        prof_count(ProfCounter::BytesWritten, block.count * record_size);
+        if (journal) {
+            journal_call([&] { journal->add(block.first, block.count); });
+        }
+        ++blocks_written;
+        free_blocks.push(std::move(block));
+    }
+    // Also stops the producer early after a failed write
+    free_blocks.close();
+    full_blocks.close();
+    producer.join();
+    if (journal) {
+        // Whatever was written is journaled, even if the producer or a later write failed
+        journal_call([&] { journal->flush(); });
+    }
+    if (out != fh) {
+        MPI_File_close(&out);
+    }
+    MPI_File_close(&fh);
+    if (producer_error) {
+        std::rethrow_exception(producer_error);
+    }
+    if (write_failed) {
+        throw std::runtime_error("Cannot write output file: " + filename);
+    }
+    LOG_INFO("Rank " + std::to_string(rank) + ": Streamed " + std::to_string(blocks_written) + " blocks to " + filename);
+}
@@ -0,0 +1,30 @@
+#ifndef STREAMING_HPP
+#define STREAMING_HPP
+
+#include "../io/checkpoint.hpp"
+#include "../utils/permutation.hpp"
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Where stream_ists_binary journals the blocks it has written (see
+// io/checkpoint.hpp), and how often it syncs them.
+struct StreamCheckpoint {
+    std::string dir;
+    int generation = 0;
+    double interval_seconds = 60;
+};
+
+// Computes the ISTs for the vertex ranks in ranges and writes them to the
+// binary .ist file block by block. Records outside ranges are left as they
+// are, so a resumed run only fills in what is missing. A producer thread
+// fills blocks of block_size records with OpenMP while the calling thread
+// writes finished blocks with MPI-IO; at most queue_depth + 1 blocks exist at
+// once, so memory does not grow with n. Collective over MPI_COMM_WORLD (file open/close);
+// only the calling thread makes MPI calls. With a checkpoint, every written
+// block is journaled per rank.
+void stream_ists_binary(const std::vector<RankRange>& ranges, int n, const std::string& output_dir,
+                        const StreamCheckpoint* checkpoint = nullptr, size_t block_size = 1 << 16,
+                        size_t queue_depth = 4);
+
+#endif
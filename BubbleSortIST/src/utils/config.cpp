@@ -0,0 +1,220 @@
+#include "config.hpp"
+#include "../graph/bubble_sort_graph.hpp"
+#include <stdexcept>
+
+namespace {
+
+int parse_int(const std::string& option, const std::string& value) {
+    try {
+        size_t used;
+        int result = std::stoi(value, &used);
+        if (used == value.size()) {
+            return result;
+        }
+    } catch (const std::exception&) {
+    }
+    throw std::invalid_argument("Invalid value for " + option + ": " + value);
+}
+
+} // namespace
+
+Config parse_config(int argc, char* argv[]) {
+    Config config;
+    for (int i = 1; i < argc; ++i) {
+        std::string option = argv[i];
+        auto value = [&]() -> std::string {
+            if (i + 1 >= argc) {
+                throw std::invalid_argument("Missing value for " + option);
+            }
+            return argv[++i];
+        };
+
+        if (option == "-h" || option == "--help") {
+            config.help = true;
+        } else if (option == "-n" || option == "--n") {
+            config.n = parse_int(option, value());
+        } else if (option == "-o" || option == "--output-dir") {
+            config.output_dir = value();
+            if (!config.output_dir.empty() && config.output_dir.back() != '/') {
+                config.output_dir += '/';
+            }
+        } else if (option == "--format") {
+            std::string format = value();
+            if (format == "binary") {
+                config.format = OutputFormat::Binary;
+            } else if (format == "text") {
+                config.format = OutputFormat::Text;
+            } else if (format == "both") {
+                config.format = OutputFormat::Both;
+            } else {
+                throw std::invalid_argument("Invalid value for --format: " + format);
+            }
+        } else if (option == "--text-writer") {
+            std::string writer = value();
+            if (writer == "mpiio") {
+                config.text_writer = TextWriter::MpiIo;
+            } else if (writer == "gather") {
+                config.text_writer = TextWriter::Gather;
+            } else {
+                throw std::invalid_argument("Invalid value for --text-writer: " + writer);
+            }
+        } else if (option == "--partition") {
+            std::string strategy = value();
+            if (strategy == "range") {
+                config.partition = PartitionStrategy::Range;
+            } else if (strategy == "prefix") {
+                config.partition = PartitionStrategy::Prefix;
+            } else if (strategy == "metis") {
+                config.partition = PartitionStrategy::Metis;
+            } else {
+                throw std::invalid_argument("Invalid value for --partition: " + strategy);
+            }
+        } else if (option == "--partition-cache") {
+            config.partition_cache = value();
+            if (!config.partition_cache.empty() && config.partition_cache.back() != '/') {
+                config.partition_cache += '/';
+            }
+        } else if (option == "--no-partition-cache") {
+            config.partition_cache.clear();
+        } else if (option == "-t" || option == "--threads") {
+            config.threads = parse_int(option, value());
+        } else if (option == "--schedule") {
+            std::string schedule = value();
+            if (schedule == "static") {
+                config.schedule = LoopSchedule::Static;
+            } else if (schedule == "dynamic") {
+                config.schedule = LoopSchedule::Dynamic;
+            } else if (schedule == "guided") {
+                config.schedule = LoopSchedule::Guided;
+            } else if (schedule == "steal") {
+                config.schedule = LoopSchedule::Steal;
+            } else {
+                throw std::invalid_argument("Invalid value for --schedule: " + schedule);
+            }
+        } else if (option == "--chunk") {
+            config.chunk = parse_int(option, value());
+        } else if (option == "--bind") {
+            std::string binding = value();
+            if (binding == "none") {
+                config.bind = ThreadBinding::None;
+            } else if (binding == "close") {
+                config.bind = ThreadBinding::Close;
+            } else if (binding == "spread") {
+                config.bind = ThreadBinding::Spread;
+            } else {
+                throw std::invalid_argument("Invalid value for --bind: " + binding);
+            }
+        } else if (option == "--no-stream") {
+            config.streaming = false;
+        } else if (option == "--checkpoint") {
+            config.checkpoint_dir = value();
+            if (!config.checkpoint_dir.empty() && config.checkpoint_dir.back() != '/') {
+                config.checkpoint_dir += '/';
+            }
+        } else if (option == "--checkpoint-interval") {
+            config.checkpoint_interval = parse_int(option, value());
+        } else if (option == "--resume") {
+            config.resume = true;
+        } else if (option == "--no-verify") {
+            config.verify = false;
+        } else if (option == "--report") {
+            config.report = value();
+        } else if (option == "--profile") {
+            config.profile = true;
+        } else if (option == "--trace") {
+            config.trace = value();
+            config.profile = true;
+        } else {
+            throw std::invalid_argument("Unknown option: " + option);
+        }
+    }
+    if (config.n < 2 || config.n > 12) {
+        throw std::invalid_argument("n must be in 2..12, got " + std::to_string(config.n));
+    }
+    if (config.partition == PartitionStrategy::Metis && !metis_graph_fits(config.n)) {
+        throw std::invalid_argument("--partition metis supports n <= 11 with this METIS build (idx_t too narrow for B_" +
+                                    std::to_string(config.n) + "); use --partition range or prefix");
+    }
+    if (config.threads < 0) {
+        throw std::invalid_argument("--threads must be >= 0");
+    }
+    if (config.chunk < 0) {
+        throw std::invalid_argument("--chunk must be >= 0");
+    }
+    if (config.checkpoint_interval < 0) {
+        throw std::invalid_argument("--checkpoint-interval must be >= 0");
+    }
+    if (!config.checkpoint_dir.empty() &&
+        (config.partition != PartitionStrategy::Range || !config.binary_output() || !config.streaming)) {
+        throw std::invalid_argument("--checkpoint needs --partition range, binary output and streaming");
+    }
+    if (config.resume && config.checkpoint_dir.empty()) {
+        throw std::invalid_argument("--resume needs --checkpoint DIR");
+    }
+    return config;
+}
+
+std::string config_usage(const char* program) {
+    return std::string("Usage: ") + program + " [options]\n"
+           "  -n, --n N               Dimension of B_n, 2..12 (default 7)\n"
+           "  -o, --output-dir DIR    Output directory (default data/output/)\n"
+           "      --format F          binary | text | both (default both: .ist plus text export)\n"
+           "      --text-writer W     mpiio | gather, for --format text (default mpiio)\n"
+           "      --partition P       range | prefix | metis (default range); prefix keeps vertices with\n"
+           "                          equal leading symbols together to cut fewer edges, without METIS\n"
+           "      --partition-cache DIR  Where METIS partitions are cached across runs (default data/cache/)\n"
+           "      --no-partition-cache   Always run METIS and keep no cache\n"
+           "  -t, --threads N         OpenMP threads (default: OMP_NUM_THREADS)\n"
+           "      --schedule S        static | dynamic | guided | steal, for construction (default static)\n"
+           "      --chunk N           Vertices per schedule chunk, rounded up to SIMD batches (default: runtime)\n"
+           "      --bind B            none | close | spread: pin OpenMP threads to OMP_PLACES or the\n"
+           "                          MPI binding, unless OMP_PROC_BIND is set (default none)\n"
+           "      --no-stream         Build the parent table before writing the .ist file\n"
+           "      --checkpoint DIR    Journal the rank ranges on disk, so an interrupted run can be resumed\n"
+           "      --checkpoint-interval S  Seconds between checkpoint syncs (default 60)\n"
+           "      --resume            Only compute what the journals in --checkpoint DIR lack; the rank\n"
+           "                          count may differ from the interrupted run\n"
+           "      --no-verify         Skip the spanning/independence check of the .ist file\n"
+           "                          (binary and both formats only; text output is never verified)\n"
+           "      --report FILE       Append a CSV row with the configuration and timings\n"
+           "      --profile           Log per-phase and per-counter imbalance across ranks and threads\n"
+           "      --trace FILE        Also write a Chrome trace (JSON) of all phases; implies --profile\n"
+           "  -h, --help              Show this message\n";
+}
+
+const char* to_string(OutputFormat format) {
+    switch (format) {
+    case OutputFormat::Binary: return "binary";
+    case OutputFormat::Text: return "text";
+    case OutputFormat::Both: return "both";
+    }
+    return "unknown";
+}
+
+const char* to_string(LoopSchedule schedule) {
+    switch (schedule) {
+    case LoopSchedule::Static: return "static";
+    case LoopSchedule::Dynamic: return "dynamic";
+    case LoopSchedule::Guided: return "guided";
+    case LoopSchedule::Steal: return "steal";
+    }
+    return "unknown";
+}
+
+const char* to_string(ThreadBinding binding) {
+    switch (binding) {
+    case ThreadBinding::None: return "none";
+    case ThreadBinding::Close: return "close";
+    case ThreadBinding::Spread: return "spread";
+    }
+    return "unknown";
+}
+
+const char* to_string(PartitionStrategy strategy) {
+    switch (strategy) {
+    case PartitionStrategy::Range: return "range";
+    case PartitionStrategy::Prefix: return "prefix";
+    case PartitionStrategy::Metis: return "metis";
+    }
+    return "unknown";
+}
@@ -0,0 +1,48 @@
+#ifndef CONFIG_HPP
+#define CONFIG_HPP
+
+#include <string>
+
+enum class OutputFormat { Binary, Text, Both };
+enum class PartitionStrategy { Range, Prefix, Metis };
+enum class TextWriter { MpiIo, Gather };
+enum class LoopSchedule { Static, Dynamic, Guided, Steal };
+enum class ThreadBinding { None, Close, Spread };
+
+// Run configuration of bubble_sort_ist, filled from the command line.
+struct Config {
+    int n = 7;                                        // Dimension of B_n
+    std::string output_dir = "data/output/";
+    OutputFormat format = OutputFormat::Both;         // Both: .ist file plus a text export from it
+    TextWriter text_writer = TextWriter::MpiIo;       // Text format only: MPI-IO or gather to rank 0
+    PartitionStrategy partition = PartitionStrategy::Range; // Range: rank ranges, no graph; Prefix: whole prefix
+                                                      // classes, no graph; Metis: full graph + METIS
+    std::string partition_cache = "data/cache/";      // Metis: reuse partitions across runs, empty disables
+    int threads = 0;                                  // OpenMP threads, 0 keeps OMP_NUM_THREADS/default
+    LoopSchedule schedule = LoopSchedule::Static;     // Construction loops; Steal: nonmonotonic dynamic
+    int chunk = 0;                                    // Vertices per scheduling chunk, 0 for the default
+    ThreadBinding bind = ThreadBinding::None;         // Pin OpenMP threads to OMP_PLACES / the MPI binding
+    bool streaming = true;                            // Range + binary: overlap compute and output in blocks
+    std::string checkpoint_dir;                       // Streaming: journal written rank ranges here, empty disables
+    int checkpoint_interval = 60;                     // Seconds between journal syncs
+    bool resume = false;                              // Skip the rank ranges journaled by earlier runs
+    bool verify = true;                               // Binary: check the written trees
+    std::string report;                               // CSV file that gets one row of timings per run
+    bool profile = false;                             // Per-rank/per-thread phase timers and imbalance report
+    std::string trace;                                // Chrome trace output (implies profile)
+    bool help = false;
+
+    bool binary_output() const { return format != OutputFormat::Text; }
+    bool text_output() const { return format != OutputFormat::Binary; }
+};
+
+// Throws std::invalid_argument on unknown options or bad values.
+Config parse_config(int argc, char* argv[]);
+std::string config_usage(const char* program);
+
+const char* to_string(OutputFormat format);
+const char* to_string(PartitionStrategy strategy);
+const char* to_string(LoopSchedule schedule);
+const char* to_string(ThreadBinding binding);
+
+#endif
@@ -0,0 +1,34 @@
+#ifndef DIMENSION_DISPATCH_HPP
+#define DIMENSION_DISPATCH_HPP
+
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+
+// Dimensions with compile-time specialized kernels.
+constexpr int kMinDispatchN = 2;
+constexpr int kMaxDispatchN = 13;
+
+// Calls f(std::integral_constant<int, N>{}) for N == n, so f can instantiate
+// templates on N. Dispatch once around a loop, not per element.
+template <typename F>
+decltype(auto) dispatch_dimension(int n, F&& f) {
+    switch (n) {
+    case 2: return f(std::integral_constant<int, 2>{});
+    case 3: return f(std::integral_constant<int, 3>{});
+    case 4: return f(std::integral_constant<int, 4>{});
+    case 5: return f(std::integral_constant<int, 5>{});
+    case 6: return f(std::integral_constant<int, 6>{});
+    case 7: return f(std::integral_constant<int, 7>{});
+    case 8: return f(std::integral_constant<int, 8>{});
+    case 9: return f(std::integral_constant<int, 9>{});
+    case 10: return f(std::integral_constant<int, 10>{});
+    case 11: return f(std::integral_constant<int, 11>{});
+    case 12: return f(std::integral_constant<int, 12>{});
+    case 13: return f(std::integral_constant<int, 13>{});
+    }
+    throw std::invalid_argument("No specialized kernels for n=" + std::to_string(n) + " (supported: " +
+                                std::to_string(kMinDispatchN) + ".." + std::to_string(kMaxDispatchN) + ")");
+}
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef FIXED_PERMUTATION_HPP
+#define FIXED_PERMUTATION_HPP
+
+#include "permutation.hpp"
+#include <array>
+#include <cstdint>
+#include <utility>
+
+constexpr Rank constexpr_factorial(int n) {
+    return n <= 1 ? 1 : n * constexpr_factorial(n - 1);
+}
+
+template <int N>
+struct FactorialTable {
+    static constexpr std::array<Rank, N + 1> make() {
+        std::array<Rank, N + 1> f{};
+        for (int i = 0; i <= N; ++i) {
+            f[i] = constexpr_factorial(i);
+        }
+        return f;
+    }
+    static constexpr std::array<Rank, N + 1> value = make();
+};
+
+// Permutation of 1..N with N fixed at compile time, kept together with its
+// Lehmer digits. Loops over N are unrolled and the factorial divisors are
+// constants, so unranking needs no hardware division and neighbor ranks need
+// only two table lookups.
+template <int N>
+struct FixedPermutation {
+    static_assert(N >= 1 && N <= Permutation::kMaxSize, "FixedPermutation supports 1 <= N <= 16");
+
+    std::array<std::uint8_t, N> symbols; // symbols[i] = symbol (1-based) at position i (0-based)
+    std::array<std::uint8_t, N> digits;  // digits[i] = Lehmer digit of position i
+
+    static FixedPermutation unrank(Rank r) {
+        constexpr auto& f = FactorialTable<N>::value;
+        FixedPermutation p;
+        std::uint32_t unused = (1u << N) - 1;
+#pragma GCC unroll 16
+        for (int i = 0; i < N; ++i) {
+            int digit = static_cast<int>(r / f[N - 1 - i]);
+            r -= digit * f[N - 1 - i];
+            std::uint32_t m = unused;
+            for (int k = 0; k < digit; ++k) {
+                m &= m - 1;
+            }
+            int sym = __builtin_ctz(m);
+            unused &= ~(1u << sym);
+            p.symbols[i] = static_cast<std::uint8_t>(sym + 1);
+            p.digits[i] = static_cast<std::uint8_t>(digit);
+        }
+        return p;
+    }
+
+    // Rank after swapping positions t and t+1 (1-based); see adjacent_rank.
+    Rank adjacent_rank(Rank r, int t) const {
+        constexpr auto& f = FactorialTable<N>::value;
+        const Rank lt = digits[t - 1];
+        const Rank lt1 = digits[t];
+        Rank nlt, nlt1;
+        swapped_digits(t, nlt, nlt1);
+        return r + (nlt - lt) * f[N - t] + (nlt1 - lt1) * f[N - t - 1];
+    }
+
+    // Swaps positions t and t+1 in place and returns the new rank, so walks
+    // along edges never unrank again.
+    Rank swap(Rank r, int t) {
+        const Rank next = adjacent_rank(r, t);
+        Rank nlt, nlt1;
+        swapped_digits(t, nlt, nlt1);
+        digits[t - 1] = static_cast<std::uint8_t>(nlt);
+        digits[t] = static_cast<std::uint8_t>(nlt1);
+        std::swap(symbols[t - 1], symbols[t]);
+        return next;
+    }
+
+private:
+    // Only digits t and t+1 change under the swap
+    void swapped_digits(int t, Rank& nlt, Rank& nlt1) const {
+        const Rank lt = digits[t - 1];
+        const Rank lt1 = digits[t];
+        if (lt > lt1) {
+            nlt = lt1;
+            nlt1 = lt - 1;
+        } else {
+            nlt = lt1 + 1;
+            nlt1 = lt;
+        }
+    }
+};
+
+#endif
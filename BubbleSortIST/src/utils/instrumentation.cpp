@@ -0,0 +1,215 @@
+#include "instrumentation.hpp"
+#include "logging.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+#include <mpi.h>
+
+namespace {
+
+constexpr int kNumCounters = static_cast<int>(ProfCounter::Count);
+const char* const kCounterNames[kNumCounters] = {"vertices_processed", "bytes_communicated", "bytes_written"};
+
+struct Event {
+    const char* name;
+    double start; // Seconds since the rank's origin
+    double duration;
+};
+
+struct ThreadData {
+    int tid;
+    std::vector<Event> events;
+    std::int64_t counters[kNumCounters] = {};
+};
+
+std::atomic<bool> g_enabled{false};
+// Timers run on helper and OpenMP threads too, which must not call MPI
+// (MPI_THREAD_FUNNELED), so they read a local monotonic clock
+std::chrono::steady_clock::time_point g_origin;
+
+double seconds_since_origin() {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - g_origin).count();
+}
+std::mutex g_registry_mutex;
+std::vector<std::unique_ptr<ThreadData>> g_threads;
+
+ThreadData& thread_data() {
+    // Threads are numbered in order of their first event; the main thread records first
+    thread_local ThreadData* data = [] {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        g_threads.push_back(std::make_unique<ThreadData>());
+        g_threads.back()->tid = static_cast<int>(g_threads.size()) - 1;
+        return g_threads.back().get();
+    }();
+    return *data;
+}
+
+struct Stats {
+    double min = 0, max = 0, mean = 0;
+};
+
+Stats stats_of(const std::vector<double>& values) {
+    Stats s;
+    if (values.empty()) {
+        return s;
+    }
+    s.min = *std::min_element(values.begin(), values.end());
+    s.max = *std::max_element(values.begin(), values.end());
+    for (double v : values) {
+        s.mean += v;
+    }
+    s.mean /= values.size();
+    return s;
+}
+
+std::string format_stats(const Stats& s) {
+    std::ostringstream out;
+    out << "min=" << s.min << " max=" << s.max << " mean=" << s.mean
+        << " imbalance=" << (s.mean > 0 ? s.max / s.mean : 1.0);
+    return out.str();
+}
+
+// One line per event ("E name tid start duration") and per nonzero counter
+// ("C name tid value"); names contain no spaces.
+std::string serialize_local() {
+    std::ostringstream out;
+    out.precision(9);
+    for (const auto& thread : g_threads) {
+        for (const Event& e : thread->events) {
+            out << "E " << e.name << ' ' << thread->tid << ' ' << e.start << ' ' << e.duration << '\n';
+        }
+        for (int c = 0; c < kNumCounters; ++c) {
+            if (thread->counters[c] != 0) {
+                out << "C " << kCounterNames[c] << ' ' << thread->tid << ' ' << thread->counters[c] << '\n';
+            }
+        }
+    }
+    return out.str();
+}
+
+} // namespace
+
+void prof_init(bool enabled) {
+    MPI_Barrier(MPI_COMM_WORLD);
+    g_origin = std::chrono::steady_clock::now();
+    g_enabled.store(enabled, std::memory_order_relaxed);
+    if (enabled) {
+        thread_data();
+    }
+}
+
+bool prof_enabled() {
+    return g_enabled.load(std::memory_order_relaxed);
+}
+
+void prof_count(ProfCounter counter, std::int64_t amount) {
+    if (prof_enabled()) {
+        thread_data().counters[static_cast<int>(counter)] += amount;
+    }
+}
+
+ScopedTimer::ScopedTimer(const char* name) : name_(prof_enabled() ? name : nullptr), start_(0) {
+    if (name_ != nullptr) {
+        start_ = seconds_since_origin();
+    }
+}
+
+ScopedTimer::~ScopedTimer() {
+    if (name_ != nullptr) {
+        double end = seconds_since_origin();
+        thread_data().events.push_back({name_, start_, end - start_});
+    }
+}
+
+void prof_report(const std::string& trace_file) {
+    if (!prof_enabled()) {
+        return;
+    }
+    int rank, size;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &size);
+
+    std::string local = serialize_local();
+    int local_size = static_cast<int>(local.size());
+    std::vector<int> counts(size), displs(size);
+    MPI_Gather(&local_size, 1, MPI_INT, counts.data(), 1, MPI_INT, 0, MPI_COMM_WORLD);
+    std::string all;
+    if (rank == 0) {
+        for (int r = 1; r < size; ++r) {
+            displs[r] = displs[r - 1] + counts[r - 1];
+        }
+        all.resize(displs[size - 1] + counts[size - 1]);
+    }
+    MPI_Gatherv(local.data(), local_size, MPI_CHAR, all.data(), counts.data(), displs.data(), MPI_CHAR, 0, MPI_COMM_WORLD);
+    if (rank != 0) {
+        return;
+    }
+
+    // name -> rank -> tid -> total seconds (or counter value)
+    std::map<std::string, std::map<int, std::map<int, double>>> phases, counters;
+    std::ofstream trace;
+    if (!trace_file.empty()) {
+        trace.open(trace_file);
+        if (!trace.is_open()) {
+            LOG_ERROR("Failed to open trace file: " + trace_file);
+            throw std::runtime_error("Cannot open trace file: " + trace_file);
+        }
+        trace << "{\"traceEvents\": [\n";
+    }
+    bool first_event = true;
+    for (int r = 0; r < size; ++r) {
+        std::istringstream in(all.substr(displs[r], counts[r]));
+        std::string kind, name;
+        int tid;
+        while (in >> kind >> name >> tid) {
+            if (kind == "E") {
+                double start, duration;
+                in >> start >> duration;
+                phases[name][r][tid] += duration;
+                if (trace.is_open()) {
+                    trace << (first_event ? "" : ",\n") << "  {\"name\": \"" << name << "\", \"ph\": \"X\", \"pid\": " << r
+                          << ", \"tid\": " << tid << ", \"ts\": " << static_cast<std::int64_t>(start * 1e6)
+                          << ", \"dur\": " << static_cast<std::int64_t>(duration * 1e6) << "}";
+                    first_event = false;
+                }
+            } else {
+                double value;
+                in >> value;
+                counters[name][r][tid] += value;
+            }
+        }
+    }
+    if (trace.is_open()) {
+        for (int r = 0; r < size; ++r) {
+            trace << (first_event ? "" : ",\n") << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << r
+                  << ", \"args\": {\"name\": \"Rank " << r << "\"}}";
+            first_event = false;
+        }
+        trace << "\n]}\n";
+        LOG_INFO("Chrome trace written to " + trace_file);
+    }
+
+    // Ranks that never reached a phase count as 0, which is an imbalance too
+    auto report = [size](const std::string& label, const std::map<std::string, std::map<int, std::map<int, double>>>& data) {
+        for (const auto& entry : data) {
+            std::vector<double> per_rank(size, 0.0), per_thread;
+            for (const auto& rank_entry : entry.second) {
+                for (const auto& thread_entry : rank_entry.second) {
+                    per_rank[rank_entry.first] += thread_entry.second;
+                    per_thread.push_back(thread_entry.second);
+                }
+            }
+            LOG_INFO(label + " " + entry.first + ": ranks " + format_stats(stats_of(per_rank)) + "; threads (" +
+                     std::to_string(per_thread.size()) + ") " + format_stats(stats_of(per_thread)));
+        }
+    };
+    report("Phase", phases);
+    report("Counter", counters);
+}
@@ -0,0 +1,39 @@
+#ifndef INSTRUMENTATION_HPP
+#define INSTRUMENTATION_HPP
+
+#include <cstdint>
+#include <string>
+
+// Low-overhead phase timers and counters. While disabled (the default) a
+// ScopedTimer or prof_count costs one relaxed atomic load. When enabled, each
+// thread appends to its own buffer; prof_report gathers all ranks' buffers to
+// rank 0 for an imbalance report and an optional Chrome trace.
+
+enum class ProfCounter { VerticesProcessed, BytesCommunicated, BytesWritten, Count };
+
+// Enables collection and sets the common time origin. Collective; call after MPI_Init.
+void prof_init(bool enabled);
+bool prof_enabled();
+
+void prof_count(ProfCounter counter, std::int64_t amount);
+
+// Records [construction, destruction) as one event of the calling thread.
+// name must outlive prof_report (string literals).
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name);
+    ~ScopedTimer();
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char* name_;
+    double start_;
+};
+
+// Collective. Rank 0 logs per-phase and per-counter min/max/mean across
+// ranks and threads, and writes a Chrome trace (chrome://tracing, Perfetto)
+// to trace_file unless it is empty. Call when no other thread is recording.
+void prof_report(const std::string& trace_file);
+
+#endif
@@ -1,15 +1,177 @@
 #include "logging.hpp"
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
 #include <mpi.h>
 
+namespace {
+
+// Bytes a thread buffers before waking the drain thread early
+constexpr size_t kWakeThreshold = 64 * 1024;
+constexpr auto kDrainInterval = std::chrono::milliseconds(50);
+
+struct ThreadBuffer {
+    std::mutex mutex;
+    std::string data;
+};
+
+std::atomic<int> g_rank{-1};
+std::atomic<bool> g_async{false};
+
+std::mutex g_registry_mutex; // Guards g_buffers, g_stop and the drain thread
+std::vector<std::shared_ptr<ThreadBuffer>> g_buffers;
+std::condition_variable g_wake;
+bool g_stop = false;
+std::thread g_drain_thread;
+std::mutex g_output_mutex; // Serializes writes to stdout/stderr
+
+int cached_rank() {
+    int rank = g_rank.load(std::memory_order_relaxed);
+    if (rank < 0) {
+        int initialized = 0;
+        MPI_Initialized(&initialized);
+        if (initialized) {
+            MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+            g_rank.store(rank, std::memory_order_relaxed);
+        }
+    }
+    return rank;
+}
+
+ThreadBuffer& thread_buffer() {
+    // The registry keeps the buffer alive after its thread exits, so nothing is lost
+    thread_local std::shared_ptr<ThreadBuffer> buffer = [] {
+        auto b = std::make_shared<ThreadBuffer>();
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        g_buffers.push_back(b);
+        return b;
+    }();
+    return *buffer;
+}
+
+void write_out(FILE* stream, const std::string& data) {
+    if (data.empty()) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(g_output_mutex);
+    std::fwrite(data.data(), 1, data.size(), stream);
+    std::fflush(stream);
+}
+
+// Caller holds g_registry_mutex
+void drain_locked() {
+    std::string pending;
+    for (const auto& buffer : g_buffers) {
+        std::lock_guard<std::mutex> lock(buffer->mutex);
+        pending += buffer->data;
+        buffer->data.clear();
+    }
+    write_out(stdout, pending);
+}
+
+void drain_loop() {
+    std::unique_lock<std::mutex> lock(g_registry_mutex);
+    while (!g_stop) {
+        g_wake.wait_for(lock, kDrainInterval);
+        drain_locked();
+    }
+}
+
+void append_line(std::string& out, const char* tag, const std::string& message) {
+    out += '[';
+    out += tag;
+    out += "][Rank ";
+    out += std::to_string(cached_rank());
+    out += "] ";
+    out += message;
+    out += '\n';
+}
+
+void log_buffered(const char* tag, const std::string& message) {
+    if (!g_async.load(std::memory_order_acquire)) {
+        std::string line;
+        append_line(line, tag, message);
+        write_out(stdout, line);
+        return;
+    }
+    ThreadBuffer& buffer = thread_buffer();
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(buffer.mutex);
+        append_line(buffer.data, tag, message);
+        wake = buffer.data.size() >= kWakeThreshold;
+    }
+    if (wake) {
+        g_wake.notify_one();
+    }
+}
+
+LogLevel parse_level(const char* value, LogLevel fallback) {
+    if (value == nullptr) return fallback;
+    if (std::strcmp(value, "debug") == 0) return LogLevel::Debug;
+    if (std::strcmp(value, "info") == 0) return LogLevel::Info;
+    if (std::strcmp(value, "error") == 0) return LogLevel::Error;
+    if (std::strcmp(value, "off") == 0) return LogLevel::Off;
+    return fallback;
+}
+
+} // namespace
+
+std::atomic<int> logging_detail::runtime_level{static_cast<int>(LogLevel::Info)};
+
+void log_init() {
+    cached_rank();
+    set_log_level(parse_level(std::getenv("BSIST_LOG_LEVEL"), log_level()));
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    if (!g_drain_thread.joinable()) {
+        g_stop = false;
+        g_drain_thread = std::thread(drain_loop);
+        g_async.store(true, std::memory_order_release);
+    }
+}
+
+void log_shutdown() {
+    {
+        std::lock_guard<std::mutex> lock(g_registry_mutex);
+        if (!g_drain_thread.joinable()) {
+            return;
+        }
+        g_async.store(false, std::memory_order_release);
+        g_stop = true;
+    }
+    g_wake.notify_one();
+    g_drain_thread.join();
+    log_flush();
+}
+
+void log_flush() {
+    std::lock_guard<std::mutex> lock(g_registry_mutex);
+    drain_locked();
+}
+
+void set_log_level(LogLevel level) {
+    logging_detail::runtime_level.store(static_cast<int>(level), std::memory_order_relaxed);
+}
+
+void log_debug(const std::string& message) {
+    log_buffered("DEBUG", message);
+}
+
 void log_info(const std::string& message) {
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    std::cout << "[INFO][Rank " << rank << "] " << message << std::endl;
+    log_buffered("INFO", message);
 }
 
 void log_error(const std::string& message) {
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-    std::cerr << "[ERROR][Rank " << rank << "] " << message << std::endl;
-}
\ No newline at end of file
+    // Pending output goes first so the error lands after the lines leading up to it
+    log_flush();
+    std::string line;
+    append_line(line, "ERROR", message);
+    write_out(stderr, line);
+}
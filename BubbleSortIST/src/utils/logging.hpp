@@ -1,9 +1,44 @@
 #ifndef LOGGING_HPP
 #define LOGGING_HPP
 
+#include <atomic>
 #include <string>
 
+enum class LogLevel { Debug = 0, Info = 1, Error = 2, Off = 3 };
+
+// Levels below LOG_COMPILE_LEVEL are compiled out of the LOG_* macros.
+#ifndef LOG_COMPILE_LEVEL
+#define LOG_COMPILE_LEVEL 0
+#endif
+
+// Caches the MPI rank and starts the background thread that drains the
+// per-thread buffers to stdout. The runtime level defaults to Info and can be
+// set with BSIST_LOG_LEVEL=debug|info|error|off. Call after MPI_Init.
+void log_init();
+// Drains all buffers and stops the background thread. Call before MPI_Finalize.
+void log_shutdown();
+void log_flush();
+
+namespace logging_detail {
+extern std::atomic<int> runtime_level;
+}
+
+void set_log_level(LogLevel level);
+inline LogLevel log_level() {
+    return static_cast<LogLevel>(logging_detail::runtime_level.load(std::memory_order_relaxed));
+}
+inline bool log_enabled(LogLevel level) {
+    return static_cast<int>(level) >= LOG_COMPILE_LEVEL && level >= log_level();
+}
+
+// Unconditional sinks; prefer the LOG_* macros, which skip building the
+// message when the level is disabled.
+void log_debug(const std::string& message);
 void log_info(const std::string& message);
-void log_error(const std::string& message);
+void log_error(const std::string& message); // Written to stderr immediately
+
+#define LOG_DEBUG(message) do { if (log_enabled(LogLevel::Debug)) log_debug(message); } while (0)
+#define LOG_INFO(message) do { if (log_enabled(LogLevel::Info)) log_info(message); } while (0)
+#define LOG_ERROR(message) do { if (log_enabled(LogLevel::Error)) log_error(message); } while (0)
 
-#endif
\ No newline at end of file
+#endif
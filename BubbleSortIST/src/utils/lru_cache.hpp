@@ -0,0 +1,75 @@
+#ifndef LRU_CACHE_HPP
+#define LRU_CACHE_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <utility>
+
+// Thread-safe map of at most `capacity` entries that evicts the least
+// recently used one. A capacity of 0 disables it: get misses, put drops.
+template <typename Key, typename Value, typename Hash = std::hash<Key>>
+class LruCache {
+public:
+    explicit LruCache(size_t capacity) : capacity_(capacity) {}
+
+    // Copies the value out on a hit and marks the entry most recently used.
+    bool get(const Key& key, Value& value) {
+        if (capacity_ == 0) {
+            return false;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it == index_.end()) {
+            ++misses_;
+            return false;
+        }
+        entries_.splice(entries_.begin(), entries_, it->second);
+        value = it->second->second;
+        ++hits_;
+        return true;
+    }
+
+    void put(const Key& key, Value value) {
+        if (capacity_ == 0) {
+            return;
+        }
+        std::lock_guard<std::mutex> lock(mutex_);
+        auto it = index_.find(key);
+        if (it != index_.end()) {
+            it->second->second = std::move(value);
+            entries_.splice(entries_.begin(), entries_, it->second);
+            return;
+        }
+        if (entries_.size() == capacity_) {
+            index_.erase(entries_.back().first);
+            entries_.pop_back();
+        }
+        entries_.emplace_front(key, std::move(value));
+        index_[key] = entries_.begin();
+    }
+
+    size_t capacity() const { return capacity_; }
+    std::int64_t hits() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return hits_;
+    }
+    std::int64_t misses() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return misses_;
+    }
+
+private:
+    using Entry = std::pair<Key, Value>;
+
+    size_t capacity_;
+    std::list<Entry> entries_; // Most recently used first
+    std::unordered_map<Key, typename std::list<Entry>::iterator, Hash> index_;
+    std::int64_t hits_ = 0;
+    std::int64_t misses_ = 0;
+    mutable std::mutex mutex_;
+};
+
+#endif
@@ -0,0 +1,11 @@
+#include "parent_table.hpp"
+
+ParentTable::ParentTable(size_t rows, int n)
+    : data_(new int[rows * (n - 1)]), rows_(rows), trees_(n - 1) {
+    const std::ptrdiff_t count = static_cast<std::ptrdiff_t>(rows * trees_);
+    int* data = data_.get();
+    #pragma omp parallel for schedule(static)
+    for (std::ptrdiff_t i = 0; i < count; ++i) {
+        data[i] = -1;
+    }
+}
@@ -0,0 +1,35 @@
+#ifndef PARENT_TABLE_HPP
+#define PARENT_TABLE_HPP
+
+#include <cstddef>
+#include <memory>
+
+// Parents of a set of vertices in one flat allocation: row i holds the n-1
+// trees of the i-th vertex, parent rank or -1 for the root.
+//
+// The memory is left untouched by the allocating thread and filled with -1
+// by an OpenMP static loop over the rows, so on NUMA machines each page
+// lands on the node of the thread that, under the same static split, later
+// computes those rows.
+class ParentTable {
+public:
+    ParentTable() = default;
+    ParentTable(size_t rows, int n);
+
+    size_t size() const { return rows_; }
+    bool empty() const { return rows_ == 0; }
+    int trees() const { return trees_; }
+    int* data() { return data_.get(); }
+    const int* data() const { return data_.get(); }
+    int* row(size_t i) { return data_.get() + i * trees_; }
+    const int* row(size_t i) const { return data_.get() + i * trees_; }
+    // Parent of row i in T_t (1-based t).
+    int parent(size_t i, int t) const { return data_[i * trees_ + t - 1]; }
+
+private:
+    std::unique_ptr<int[]> data_;
+    size_t rows_ = 0;
+    int trees_ = 0;
+};
+
+#endif
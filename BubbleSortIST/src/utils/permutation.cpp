@@ -1,28 +1,135 @@
 #include "permutation.hpp"
-#include <sstream>
+#include <stdexcept>
 
-Permutation::Permutation(const std::vector<int>& p) : perm(p) {}
+namespace {
+
+constexpr int kMaxRankedN = 20; // 20! is the largest factorial that fits in Rank
+
+const Rank* factorial_table() {
+    static const auto table = [] {
+        static Rank f[kMaxRankedN + 1];
+        f[0] = 1;
+        for (int i = 1; i <= kMaxRankedN; ++i) {
+            f[i] = f[i - 1] * i;
+        }
+        return f;
+    }();
+    return table;
+}
+
+} // namespace
+
+Rank factorial(int n) {
+    if (n < 0 || n > kMaxRankedN) {
+        throw std::out_of_range("factorial: n out of range");
+    }
+    return factorial_table()[n];
+}
+
+Permutation::Permutation(const std::vector<int>& p) : n_(static_cast<std::uint8_t>(p.size())) {
+    if (p.size() > static_cast<size_t>(kMaxSize)) {
+        throw std::invalid_argument("Permutation supports at most 16 symbols");
+    }
+    for (size_t i = 0; i < p.size(); ++i) {
+        word_ |= static_cast<std::uint64_t>(p[i] - 1) << (4 * i);
+    }
+}
+
+Permutation Permutation::identity(int n) {
+    Permutation p;
+    p.n_ = static_cast<std::uint8_t>(n);
+    for (int i = 0; i < n; ++i) {
+        p.word_ |= static_cast<std::uint64_t>(i) << (4 * i);
+    }
+    return p;
+}
 
 Permutation Permutation::swap(int i) const {
-    std::vector<int> new_perm = perm;
-    if (i >= 1 && i < static_cast<int>(perm.size())) {
-        std::swap(new_perm[i - 1], new_perm[i]);
+    Permutation result = *this;
+    if (i >= 1 && i < n_) {
+        const int shift = 4 * (i - 1);
+        std::uint64_t x = ((word_ >> shift) ^ (word_ >> (shift + 4))) & 0xF;
+        result.word_ ^= (x << shift) | (x << (shift + 4));
     }
-    return Permutation(new_perm);
+    return result;
 }
 
 bool Permutation::operator==(const Permutation& other) const {
-    return perm == other.perm;
+    return word_ == other.word_ && n_ == other.n_;
 }
 
 bool Permutation::operator!=(const Permutation& other) const {
     return !(*this == other);
 }
 
+void Permutation::to_chars(char* out) const {
+    // Symbols above 9 continue with letters (A = 10, ..., G = 16)
+    for (int i = 0; i < n_; ++i) {
+        int x = (*this)[i];
+        out[i] = static_cast<char>(x < 10 ? '0' + x : 'A' + (x - 10));
+    }
+}
+
 std::string Permutation::to_string() const {
-    std::stringstream ss;
-    for (int x : perm) {
-        ss << x;
+    std::string s(n_, '0');
+    to_chars(&s[0]);
+    return s;
+}
+
+Rank Permutation::rank() const {
+    // Lehmer digit i counts the symbols right of position i that are smaller
+    // than perm[i]; with a bitmask of unused symbols that is a single popcount.
+    const int n = n_;
+    const Rank* f = factorial_table();
+    std::uint32_t unused = (1u << n) - 1;
+    Rank r = 0;
+    for (int i = 0; i < n; ++i) {
+        std::uint32_t bit = 1u << ((word_ >> (4 * i)) & 0xF);
+        r += __builtin_popcount(unused & (bit - 1)) * f[n - 1 - i];
+        unused &= ~bit;
     }
-    return ss.str();
-}
\ No newline at end of file
+    return r;
+}
+
+Permutation Permutation::unrank(Rank r, int n) {
+    if (n < 1 || n > kMaxSize || r < 0 || r >= factorial(n)) {
+        throw std::out_of_range("Permutation::unrank: rank out of range");
+    }
+    const Rank* f = factorial_table();
+    Permutation p;
+    p.n_ = static_cast<std::uint8_t>(n);
+    std::uint32_t unused = (1u << n) - 1;
+    for (int i = 0; i < n; ++i) {
+        int digit = static_cast<int>(r / f[n - 1 - i]);
+        r %= f[n - 1 - i];
+        // Select the digit-th unused symbol.
+        std::uint32_t m = unused;
+        for (int k = 0; k < digit; ++k) {
+            m &= m - 1;
+        }
+        int sym = __builtin_ctz(m);
+        unused &= ~(1u << sym);
+        p.word_ |= static_cast<std::uint64_t>(sym) << (4 * i);
+    }
+    return p;
+}
+
+Rank adjacent_rank(Rank r, int n, int t) {
+    // Swapping positions t and t+1 only changes Lehmer digits L_t and L_{t+1}.
+    // With a = v_t and b = v_{t+1}: a > b iff L_t > L_{t+1}, and then
+    //   L'_t = L_{t+1} + [a < b],  L'_{t+1} = L_t - [a > b].
+    const Rank* f = factorial_table();
+    Rank wt = f[n - t];     // weight of position t
+    Rank wt1 = f[n - t - 1]; // weight of position t+1
+    Rank lt = (r / wt) % (n - t + 1);
+    Rank lt1 = (r / wt1) % (n - t);
+    Rank nlt, nlt1;
+    if (lt > lt1) {
+        nlt = lt1;
+        nlt1 = lt - 1;
+    } else {
+        nlt = lt1 + 1;
+        nlt1 = lt;
+    }
+    return r + (nlt - lt) * wt + (nlt1 - lt1) * wt1;
+}
@@ -3,18 +3,56 @@
 
 #include <vector>
 #include <string>
+#include <cstdint>
+#include <functional>
 
+using Rank = std::int64_t; // Lexicographic (Lehmer-code) rank of a permutation
+
+Rank factorial(int n);
+
+// Permutation of 1..n (n <= 16) packed as 4-bit symbols in one 64-bit word:
+// position i (0-based) holds symbol-1 in bits [4i, 4i+4). Copies, swaps,
+// comparisons and hashing never allocate.
 class Permutation {
 public:
+    static constexpr int kMaxSize = 16;
+
+    Permutation() = default;
     explicit Permutation(const std::vector<int>& p);
+    static Permutation identity(int n);
+
     Permutation swap(int i) const; // Swap positions i and i+1
-    int operator[](int i) const { return perm[i]; }
+    int operator[](int i) const { return static_cast<int>((word_ >> (4 * i)) & 0xF) + 1; }
+    int size() const { return n_; }
+    std::uint64_t word() const { return word_; }
     bool operator==(const Permutation& other) const;
     bool operator!=(const Permutation& other) const;
     std::string to_string() const;
+    void to_chars(char* out) const; // Writes size() characters, no terminator
+
+    Rank rank() const; // Lehmer-code rank in [0, n!), identity has rank 0
+    static Permutation unrank(Rank r, int n);
 
 private:
-    std::vector<int> perm;
+    std::uint64_t word_ = 0;
+    std::uint8_t n_ = 0;
+};
+
+namespace std {
+template <>
+struct hash<Permutation> {
+    size_t operator()(const Permutation& p) const noexcept {
+        // splitmix64 finalizer over the packed word and length
+        std::uint64_t x = p.word() ^ (static_cast<std::uint64_t>(p.size()) << 60);
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return static_cast<size_t>(x ^ (x >> 31));
+    }
 };
+} // namespace std
+
+// Rank of the vertex obtained by swapping positions t and t+1 (1-based) of the
+// permutation with rank r, computed from its Lehmer digits without unranking.
+Rank adjacent_rank(Rank r, int n, int t);
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,33 @@
+#include "run_report.hpp"
+#include "logging.hpp"
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+
+void append_run_report(const std::string& filename, const Config& config, int num_processes, int num_threads,
+                       const RunTimings& timings, const PartitionQuality& partition_quality, bool verified) {
+    std::error_code ec;
+    bool write_header = !std::filesystem::exists(filename, ec) || std::filesystem::file_size(filename, ec) == 0;
+    std::ofstream out(filename, std::ios::app);
+    if (!out.is_open()) {
+        LOG_ERROR("Failed to open report file: " + filename);
+        throw std::runtime_error("Cannot open report file: " + filename);
+    }
+    if (write_header) {
+        out << "n,np,threads,partition,format,streaming,schedule,chunk,bind,edge_cut,imbalance,graph_s,partition_s,local_vertices_s,ist_s,gather_s,"
+               "output_s,verify_s,total_s,verified\n";
+    }
+    out << config.n << ',' << num_processes << ',' << num_threads << ',' << to_string(config.partition) << ','
+        << to_string(config.format) << ',' << (config.streaming ? 1 : 0) << ',' << to_string(config.schedule) << ','
+        << config.chunk << ',' << to_string(config.bind) << ',';
+    if (partition_quality.measured()) {
+        out << partition_quality.edge_cut << ',' << partition_quality.imbalance << ',';
+    } else {
+        out << ",,";
+    }
+    out << timings.graph << ','
+        << timings.partition << ',' << timings.local_vertices << ',' << timings.ist << ',' << timings.gather << ','
+        << timings.output << ',' << timings.verify << ',' << timings.total << ','
+        << (config.verify && config.binary_output() ? (verified ? "yes" : "no") : "skipped") << '\n';
+    LOG_INFO("Run report appended to " + filename);
+}
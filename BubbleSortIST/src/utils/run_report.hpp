@@ -0,0 +1,26 @@
+#ifndef RUN_REPORT_HPP
+#define RUN_REPORT_HPP
+
+#include "config.hpp"
+#include "../graph/partition_quality.hpp"
+#include <string>
+
+// Wall-clock seconds of each phase of a run, as measured on rank 0.
+struct RunTimings {
+    double graph = 0;
+    double partition = 0;
+    double local_vertices = 0;
+    double ist = 0;
+    double gather = 0;
+    double output = 0;
+    double verify = 0;
+    double total = 0;
+};
+
+// Appends one CSV row (configuration, process/thread counts, partition
+// quality if measured, timings, verification status) to filename, writing the header first if the file is
+// new or empty.
+void append_run_report(const std::string& filename, const Config& config, int num_processes, int num_threads,
+                       const RunTimings& timings, const PartitionQuality& partition_quality, bool verified);
+
+#endif
@@ -0,0 +1,126 @@
+// Checks IstQueryEngine against parent_ranks on small n: every parent and
+// every root path (the parent_ranks chain down to rank 0) must match, for
+// single and batched queries, with the path cache off, large enough for all
+// paths, and small enough to evict. Cached runs must count the expected hits
+// and misses, and out-of-range queries must throw std::invalid_argument.
+// Exits nonzero on any mismatch.
+#include <functional>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "../src/algorithm/ist_construct.hpp"
+#include "../src/algorithm/ist_query.hpp"
+#include "../src/utils/permutation.hpp"
+
+namespace {
+
+int g_failures = 0;
+
+void expect(bool ok, int n, const std::string& what) {
+    if (!ok) {
+        std::cerr << "B_" << n << ": " << what << "\n";
+        ++g_failures;
+    }
+}
+
+void expect_invalid(const std::function<void()>& call, int n, const std::string& what) {
+    bool thrown = false;
+    try {
+        call();
+    } catch (const std::invalid_argument&) {
+        thrown = true;
+    }
+    expect(thrown, n, what + " did not throw std::invalid_argument");
+}
+
+// Answers from the parent table of parent_ranks, one row per vertex
+struct Expected {
+    std::vector<IstQuery> queries;
+    std::vector<Rank> parents;
+    std::vector<std::vector<Rank>> paths;
+};
+
+Expected expected_answers(int n) {
+    const Rank num_vertices = factorial(n);
+    std::vector<int> table(num_vertices * (n - 1));
+    for (Rank v = 0; v < num_vertices; ++v) {
+        parent_ranks(v, n, table.data() + v * (n - 1));
+    }
+    Expected expected;
+    for (Rank v = 0; v < num_vertices; ++v) {
+        for (int t = 1; t <= n - 1; ++t) {
+            expected.queries.push_back({v, t});
+            expected.parents.push_back(table[v * (n - 1) + t - 1]);
+            std::vector<Rank> path{v};
+            while (path.back() != 0 && static_cast<Rank>(path.size()) <= num_vertices) {
+                path.push_back(table[path.back() * (n - 1) + t - 1]);
+            }
+            expected.paths.push_back(path);
+        }
+    }
+    return expected;
+}
+
+// Single and batched answers of one engine; returns the path lookups made.
+std::int64_t check_answers(const IstQueryEngine& engine, const Expected& expected, int n, const std::string& label) {
+    const size_t count = expected.queries.size();
+    bool parents_ok = engine.parents(expected.queries) == expected.parents;
+    bool paths_ok = engine.paths_to_root(expected.queries) == expected.paths;
+    for (size_t i = 0; i < count; ++i) {
+        const IstQuery& q = expected.queries[i];
+        parents_ok = parents_ok && engine.parent(q.vertex, q.tree) == expected.parents[i];
+        paths_ok = paths_ok && engine.path_to_root(q.vertex, q.tree) == expected.paths[i];
+    }
+    // Again, now answered from whatever the cache kept
+    paths_ok = paths_ok && engine.paths_to_root(expected.queries) == expected.paths;
+    expect(parents_ok, n, label + ": parents differ from parent_ranks");
+    expect(paths_ok, n, label + ": root paths differ from the parent_ranks chain");
+    return 3 * static_cast<std::int64_t>(count);
+}
+
+void check_out_of_range(const IstQueryEngine& engine, int n, const std::string& label) {
+    const Rank num_vertices = factorial(n);
+    expect_invalid([&] { engine.parent(-1, 1); }, n, label + ": parent(-1, 1)");
+    expect_invalid([&] { engine.parent(num_vertices, 1); }, n, label + ": parent(n!, 1)");
+    expect_invalid([&] { engine.parent(0, 0); }, n, label + ": parent(0, 0)");
+    expect_invalid([&] { engine.parent(0, n); }, n, label + ": parent(0, n)");
+    expect_invalid([&] { engine.path_to_root(num_vertices, 1); }, n, label + ": path_to_root(n!, 1)");
+    expect_invalid([&] { engine.path_to_root(0, n); }, n, label + ": path_to_root(0, n)");
+    expect_invalid([&] { engine.parents({{0, 1}, {num_vertices, 1}}); }, n, label + ": parents with a bad vertex");
+    expect_invalid([&] { engine.paths_to_root({{0, 1}, {0, 0}}); }, n, label + ": paths_to_root with a bad tree");
+}
+
+void check(int n) {
+    const Expected expected = expected_answers(n);
+    const std::int64_t count = static_cast<std::int64_t>(expected.queries.size());
+
+    const IstQueryEngine uncached(n);
+    check_answers(uncached, expected, n, "uncached");
+    expect(uncached.cache_hits() == 0 && uncached.cache_misses() == 0, n, "uncached: cache counters moved");
+    check_out_of_range(uncached, n, "uncached");
+
+    // Holds every path: only the first lookup of each one misses
+    const IstQueryEngine cached(n, count);
+    const std::int64_t lookups = check_answers(cached, expected, n, "cached");
+    expect(cached.cache_misses() == count && cached.cache_hits() == lookups - count, n,
+           "cached: " + std::to_string(cached.cache_hits()) + " hits, " + std::to_string(cached.cache_misses()) +
+               " misses for " + std::to_string(count) + " distinct paths");
+    check_out_of_range(cached, n, "cached");
+
+    // Evicts constantly, which must not change any answer
+    const IstQueryEngine evicting(n, 4);
+    const std::int64_t evicting_lookups = check_answers(evicting, expected, n, "evicting");
+    expect(evicting.cache_hits() + evicting.cache_misses() == evicting_lookups, n, "evicting: lookups not all counted");
+}
+
+} // namespace
+
+int main() {
+    for (int n = 3; n <= 7; ++n) {
+        check(n);
+    }
+    expect_invalid([] { IstQueryEngine engine(1); }, 1, "IstQueryEngine(1)");
+    std::cout << (g_failures == 0 ? "All checks passed" : std::to_string(g_failures) + " failures") << "\n";
+    return g_failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,59 @@
+// Checks PrefixPartition against brute force on small n: the parts must
+// cover every rank exactly once, part() must agree with range(), and the
+// closed-form quality() must equal measure_partition over all edges.
+// Exits nonzero on any mismatch.
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "../src/graph/partition_quality.hpp"
+#include "../src/parallel/prefix_partition.hpp"
+#include "../src/utils/permutation.hpp"
+
+namespace {
+
+bool check(int n, int nparts) {
+    const Rank num_vertices = factorial(n);
+    PrefixPartition partition(n, nparts, 1.05);
+    std::vector<idx_t> parts(num_vertices, -1);
+    Rank covered = 0;
+    for (int p = 0; p < nparts; ++p) {
+        const auto range = partition.range(p);
+        for (Rank v = range.first; v < range.second; ++v) {
+            parts[v] = p;
+        }
+        covered += range.second - range.first;
+    }
+
+    const PartitionQuality expected = measure_partition(n, nparts, parts.data());
+    const PartitionQuality actual = partition.quality();
+    bool ok = covered == num_vertices;
+    for (Rank v = 0; ok && v < num_vertices; ++v) {
+        ok = parts[v] >= 0 && partition.part(v) == parts[v];
+    }
+    ok = ok && actual.edge_cut == expected.edge_cut && actual.num_edges == expected.num_edges &&
+         std::fabs(actual.imbalance - expected.imbalance) < 1e-9;
+    if (!ok) {
+        std::cerr << "B_" << n << ", " << nparts << " parts, L = " << partition.prefix_length() << ": "
+                  << actual.describe() << ", brute force " << expected.describe() << "\n";
+    }
+    return ok;
+}
+
+} // namespace
+
+int main() {
+    int cases = 0, failures = 0;
+    for (int n = 2; n <= 9; ++n) {
+        for (int nparts : {1, 2, 3, 4, 5, 7, 8, 12, 16, 33, 64, 100, 1000}) {
+            if (nparts > factorial(n)) {
+                continue;
+            }
+            ++cases;
+            if (!check(n, nparts)) {
+                ++failures;
+            }
+        }
+    }
+    std::cout << cases << " cases, " << failures << " failures\n";
+    return failures == 0 ? 0 : 1;
+}